@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include "analysisstate.h"
+
+namespace
+{
+    constexpr uint32_t STATE_FILE_MAGIC = 0x5348444d; // "MDHS" in little endian
+    constexpr uint32_t STATE_FILE_VERSION = 4;
+
+    constexpr uint8_t MINIMUM_AMOUNT_OF_SAMPLES = 10;
+
+    // 128 bit product of two 64 bit values as {high, low} pair, portable replacement of unsigned __int128
+    std::pair<uint64_t, uint64_t> multiplyWide(uint64_t first, uint64_t second)
+    {
+        constexpr uint64_t LOW_MASK = 0xffffffff;
+
+        const auto low_low = (first & LOW_MASK) * (second & LOW_MASK);
+        const auto high_low = (first >> 32) * (second & LOW_MASK);
+        const auto low_high = (first & LOW_MASK) * (second >> 32);
+        const auto high_high = (first >> 32) * (second >> 32);
+
+        const auto middle = (low_low >> 32) + (high_low & LOW_MASK) + low_high;
+
+        return {high_high + (high_low >> 32) + (middle >> 32), (middle << 32) | (low_low & LOW_MASK)};
+    }
+
+    template <class ValueType>
+    void writeValue(std::ostream& stream, const ValueType& value)
+    {
+        static_assert(std::is_trivially_copyable_v<ValueType>);
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <class ValueType>
+    bool readValue(std::istream& stream, ValueType& value)
+    {
+        static_assert(std::is_trivially_copyable_v<ValueType>);
+        return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    void writeHistogram(std::ostream& stream, const std::vector<common::SplitOccurenceType>& histogram)
+    {
+        writeValue(stream, static_cast<uint32_t>(histogram.size()));
+        stream.write(reinterpret_cast<const char*>(histogram.data()),
+            static_cast<std::streamsize>(histogram.size() * sizeof(common::SplitOccurenceType)));
+    }
+
+    bool readHistogram(std::istream& stream, uint32_t size, std::vector<common::SplitOccurenceType>& histogram)
+    {
+        histogram.resize(size);
+        return static_cast<bool>(stream.read(reinterpret_cast<char*>(histogram.data()),
+            static_cast<std::streamsize>(histogram.size() * sizeof(common::SplitOccurenceType))));
+    }
+}
+
+void AnalysisState::OrientationState::addLineMatch(common::DimensionsType line, common::DimensionsType matched_pixels,
+    common::DimensionsType line_width, SampleAvgStorage::Ratio minimum_pixel_match_ratio)
+{
+    if (m_comparisons.getSampleCount() > MINIMUM_AMOUNT_OF_SAMPLES && 
+        m_comparisons.isBelowAverage(matched_pixels, line_width, minimum_pixel_match_ratio))
+    {
+        m_split_histogram[line]++;
+    }
+
+    m_comparisons.addSample(matched_pixels, line_width);
+}
+
+bool AnalysisState::OrientationState::isAverageSettled() const
+{
+    return !m_split_histogram.empty() && m_comparisons.getSampleCount() >= m_split_histogram.size();
+}
+
+void AnalysisState::OrientationState::merge(const OrientationState& other)
+{
+    if (m_split_histogram.size() < other.m_split_histogram.size())
+    {
+        m_split_histogram.resize(other.m_split_histogram.size());
+    }
+
+    for (std::size_t line = 0; line < other.m_split_histogram.size(); line++)
+    {
+        m_split_histogram[line] += other.m_split_histogram[line];
+    }
+
+    m_comparisons.merge(other.m_comparisons);
+}
+
+bool AnalysisState::merge(const AnalysisState& other)
+{
+    const auto is_other_empty = other.m_width == 0 && other.m_height == 0;
+
+    if (m_width == 0 && m_height == 0)
+    {
+        m_width = other.m_width;
+        m_height = other.m_height;
+    }
+    else if (!is_other_empty && (m_width != other.m_width || m_height != other.m_height))
+    {
+        spdlog::error("merged analysis states have different dimensions ({}x{} vs {}x{})", 
+            m_width, m_height, other.m_width, other.m_height);
+        return false;
+    }
+
+    m_processed_frames += other.m_processed_frames;
+    m_skipped_frames += other.m_skipped_frames;
+
+    m_horizontal.merge(other.m_horizontal);
+    m_vertical.merge(other.m_vertical);
+
+    return true;
+}
+
+bool AnalysisState::save(const std::string& file_path) const
+{
+    std::ofstream stream(file_path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        spdlog::error("failed to open {} for writing", file_path);
+        return false;
+    }
+
+    writeValue(stream, STATE_FILE_MAGIC);
+    writeValue(stream, STATE_FILE_VERSION);
+    writeValue(stream, m_width);
+    writeValue(stream, m_height);
+    writeValue(stream, m_processed_frames);
+    writeValue(stream, m_skipped_frames);
+
+    for (const auto* orientation : {&m_horizontal, &m_vertical})
+    {
+        writeValue(stream, orientation->m_comparisons.m_total_samples);
+        writeValue(stream, orientation->m_comparisons.m_matched_pixels);
+        writeValue(stream, orientation->m_comparisons.m_compared_pixels);
+        writeHistogram(stream, orientation->m_split_histogram);
+    }
+
+    if (!stream)
+    {
+        spdlog::error("failed to write analysis state into {}", file_path);
+        return false;
+    }
+
+    return true;
+}
+
+std::optional<AnalysisState> AnalysisState::load(const std::string& file_path)
+{
+    std::ifstream stream(file_path, std::ios::binary);
+    if (!stream)
+    {
+        spdlog::error("failed to open {} for reading", file_path);
+        return {};
+    }
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    if (!readValue(stream, magic) || magic != STATE_FILE_MAGIC)
+    {
+        spdlog::error("{} is not an analysis state file", file_path);
+        return {};
+    }
+
+    if (!readValue(stream, version) || version != STATE_FILE_VERSION)
+    {
+        spdlog::error("unsupported analysis state version {}, expected {}", version, STATE_FILE_VERSION);
+        return {};
+    }
+
+    AnalysisState state;
+    bool is_valid = readValue(stream, state.m_width) &&
+        readValue(stream, state.m_height) &&
+        readValue(stream, state.m_processed_frames) &&
+        readValue(stream, state.m_skipped_frames);
+
+    // horizontal splits are found between rows of the frame, vertical ones between its columns
+    const std::pair<OrientationState*, common::DimensionsType> orientations[] = {
+        {&state.m_horizontal, state.m_height}, {&state.m_vertical, state.m_width}};
+
+    for (const auto& [orientation, line_count] : orientations)
+    {
+        uint32_t histogram_size = 0;
+        is_valid = is_valid &&
+            readValue(stream, orientation->m_comparisons.m_total_samples) &&
+            readValue(stream, orientation->m_comparisons.m_matched_pixels) &&
+            readValue(stream, orientation->m_comparisons.m_compared_pixels) &&
+            readValue(stream, histogram_size);
+
+        // histogram is empty until the first frame is analyzed, otherwise it has an entry per line
+        if (is_valid && histogram_size != 0 && histogram_size != line_count)
+        {
+            spdlog::error("analysis state file {} is corrupted, histogram of {} lines doesn't match the dimension {}",
+                file_path, histogram_size, line_count);
+            return {};
+        }
+
+        is_valid = is_valid && readHistogram(stream, histogram_size, orientation->m_split_histogram);
+    }
+
+    if (!is_valid)
+    {
+        spdlog::error("analysis state file {} is truncated", file_path);
+        return {};
+    }
+
+    return state;
+}
+
+SampleAvgStorage::Ratio SampleAvgStorage::toFixedPointRatio(double ratio)
+{
+    const auto scaled_ratio = std::clamp(ratio * RATIO_SCALE, 0., static_cast<double>(std::numeric_limits<Ratio>::max()));
+    return static_cast<Ratio>(std::lround(scaled_ratio));
+}
+
+void SampleAvgStorage::addSample(common::DimensionsType matched_pixels, common::DimensionsType compared_pixels)
+{
+    m_matched_pixels += matched_pixels;
+    m_compared_pixels += compared_pixels;
+    m_total_samples++;
+}
+
+bool SampleAvgStorage::isBelowAverage(common::DimensionsType matched_pixels, common::DimensionsType compared_pixels,
+    Ratio ratio) const
+{
+    // matched_pixels * m_compared_pixels * ratio < m_matched_pixels * compared_pixels * RATIO_SCALE
+    return multiplyWide(uint64_t{matched_pixels} * ratio, m_compared_pixels) <
+        multiplyWide(m_matched_pixels, uint64_t{compared_pixels} * RATIO_SCALE);
+}
+
+void SampleAvgStorage::merge(const SampleAvgStorage& other)
+{
+    m_matched_pixels += other.m_matched_pixels;
+    m_compared_pixels += other.m_compared_pixels;
+    m_total_samples += other.m_total_samples;
+}
+
+double SampleAvgStorage::getTotalAverage() const
+{
+    if (m_compared_pixels == 0)
+    {
+        return 0.;
+    }
+
+    return static_cast<double>(m_matched_pixels) / static_cast<double>(m_compared_pixels) * 100.;
+}
+
+uint64_t SampleAvgStorage::getSampleCount() const
+{
+    return m_total_samples;
+}
\ No newline at end of file
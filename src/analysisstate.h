@@ -0,0 +1,91 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "commondefinitions.h"
+
+/*!
+ * @brief Maintains average match rate of lines collected for a single orientation. Matched and compared pixels
+ * are accumulated as integers, so that the average is exact regardless of the amount or the order of samples.
+ */
+struct SampleAvgStorage
+{
+    //! @brief Fixed point ratio, scaled by RATIO_SCALE.
+    using Ratio = uint32_t;
+    static constexpr Ratio RATIO_SCALE = 1000;
+
+    static Ratio toFixedPointRatio(double ratio);
+
+    void addSample(common::DimensionsType matched_pixels, common::DimensionsType compared_pixels);
+
+    //! @brief Checks whether matched_pixels / compared_pixels < average / ratio, comparison is done
+    //! by cross-multiplication, i.e. without any rounding.
+    bool isBelowAverage(common::DimensionsType matched_pixels, common::DimensionsType compared_pixels,
+        Ratio ratio) const;
+
+    //! @brief Adds samples of another storage, the result is identical to adding all of them into a single one.
+    void merge(const SampleAvgStorage& other);
+
+    uint64_t getSampleCount() const;
+
+    //! @brief Average match rate in percents, meant for reporting only.
+    double getTotalAverage() const;
+
+private:
+    friend struct AnalysisState;
+
+    uint64_t m_matched_pixels = 0;
+    uint64_t m_compared_pixels = 0;
+    uint64_t m_total_samples = 0;
+};
+
+/*!
+ * @brief Intermediate results of frame analysis, i.e. everything which is required in order to collate and filter
+ * potential splits without decoding the input again.
+ * @note Only parameters which are applied after the analysis (line match ratio) can be re-tuned using this state,
+ * the rest of them affect which lines are collected as potential splits in the first place.
+ */
+struct AnalysisState
+{
+    struct OrientationState
+    {
+        //! @brief Registers match of the line with the next one, the line is considered as a potential split
+        //! when its match rate is substantially lower than the average one.
+        void addLineMatch(common::DimensionsType line, common::DimensionsType matched_pixels,
+            common::DimensionsType line_width, SampleAvgStorage::Ratio minimum_pixel_match_ratio);
+
+        //! @brief Checks whether at least as many lines as a single frame has contributed to the average,
+        //! approximations which rely on the average shall not be used before.
+        bool isAverageSettled() const;
+
+        //! @brief Sums occurrences of potential splits and comparisons of another state of the same orientation.
+        void merge(const OrientationState& other);
+
+        // amount of occurrences of the potential split per each line
+        std::vector<common::SplitOccurenceType> m_split_histogram;
+        SampleAvgStorage m_comparisons;
+    };
+
+    common::DimensionsType m_width = 0;
+    common::DimensionsType m_height = 0;
+    uint32_t m_processed_frames = 0;
+    // amount of processed frames which were not analyzed as they were near-duplicates of the previous ones
+    uint32_t m_skipped_frames = 0;
+
+    OrientationState m_horizontal;
+    OrientationState m_vertical;
+
+    //! @brief Merges state of another (e.g. time range) analysis of the same input into this one, so that shards
+    //! of a single video can be analyzed independently and decomposed at once. States without any analyzed frame
+    //! are merged regardless of their dimensions.
+    //! @return false when dimensions of both states differ, the state is left untouched then.
+    bool merge(const AnalysisState& other);
+
+    //! @brief Stores the state into a binary file, data is written in the native byte order.
+    bool save(const std::string& file_path) const;
+
+    static std::optional<AnalysisState> load(const std::string& file_path);
+};
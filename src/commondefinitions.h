@@ -5,4 +5,6 @@
 namespace common
 {
     using DimensionsType = uint16_t;
+    // occurrences are summed over all frames of (possibly merged) analyses, so it has to fit long videos
+    using SplitOccurenceType = uint32_t;
 }
\ No newline at end of file
@@ -7,6 +7,48 @@ struct ConfigParams
     //! @brief Defines amount of frame to analyze, 0 means analyze all available frames.
     uint32_t m_frames_to_analyze = 0;
 
+    //! @brief Defines amount of frames skipped from the start of the input before the analysis,
+    //! so that a time range of a video can be analyzed independently of the rest of it.
+    uint32_t m_start_frame = 0;
+
+    //! @brief Defines amount of frames which are acquired from the frame provider at once.
+    //! Next batch is acquired while the current one is being analyzed.
+    uint16_t m_batch_size = 8;
+
+    //! @brief Defines average difference of color units between thumbnails of a frame and the last analyzed frame, 
+    //! below which the frame is skipped as a near-duplicate. 0 disables skipping.
+    //! @note skipped frames still count into the amount of frames to analyze.
+    uint16_t m_duplicate_frame_diff = 0;
+
+    //! @brief Defines whether match counts of lines which did not change since the previous frame are reused
+    //! instead of being counted again, it pays off for videos with mostly static content.
+    bool m_incremental_analysis = false;
+
+    //! @brief Defines stride of pixels sampled along each line during the coarse pass, 1 disables the coarse pass.
+    //! When enabled, match of every line is estimated out of sampled pixels first and only lines close to the ones
+    //! which look like potential splits are matched at full resolution, the rest contributes only to the average.
+    //! @note it's an approximation, the average match rate is partially based on the sampled pixels.
+    common::DimensionsType m_coarse_line_stride = 1;
+
+    //! @brief Defines amount of lines on each side of a coarse candidate which are matched at full resolution.
+    common::DimensionsType m_refine_radius = 2;
+
+    //! @brief Defines size of blocks of pixels after which it's checked whether classification of the line is settled,
+    //! the rest of the line is not matched then and its match is extrapolated. 0 disables the early exit.
+    //! @note it's an approximation, the average match rate is partially based on the extrapolated matches.
+    common::DimensionsType m_early_exit_block = 0;
+
+    //! @brief Defines how many times split detection is repeated inside of each detected mosaic, so that nested
+    //! layouts (e.g. a big mosaic next to a group of smaller ones) are recognized. 0 disables the recursion.
+    uint8_t m_recursion_depth = 0;
+
+    //! @brief Defines amount of analyzed frames which are retained in memory for the recursive decomposition.
+    //! @note each of them takes 3 bytes per pixel for the whole analysis, e.g. about 6 MB of a 1080p frame.
+    uint16_t m_recursion_frames = 16;
+
+    //! @brief Defines minimum width and height of a mosaic to be decomposed recursively.
+    common::DimensionsType m_minimum_recursive_size = 32;
+
     //! @brief Defines amount of lines from the front of the frame to be skipped during processing
     common::DimensionsType m_skip_front_lines = 5;
 
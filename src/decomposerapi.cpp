@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "decomposerapi.h"
+#include "memoryframeprovider.h"
+#include "mosaicdecomposer.h"
+#include "threadpool.h"
+
+struct md_decomposer
+{
+    md_decomposer(const ConfigParams& params, uint32_t threads) :
+        m_thread_pool(threads == 1 ? nullptr : std::make_unique<ThreadPool>(threads)),
+        m_decomposer(m_frame_provider, params, m_thread_pool.get())
+    {
+    }
+
+    std::unique_ptr<ThreadPool> m_thread_pool;
+    MemoryFrameProvider m_frame_provider;
+    MosaicDecomposer m_decomposer;
+    // descriptors of frames of the current call, kept so that their memory is reused
+    std::vector<FrameBuffer> m_buffers;
+    // mosaics of the last successful call, so that they can be copied again into a larger array
+    std::vector<md_mosaic> m_last_mosaics;
+};
+
+namespace
+{
+    // embedding applications get only warnings and errors by default, unlike the executable
+    constexpr auto DEFAULT_LOG_LEVEL = spdlog::level::warn;
+    std::once_flag is_log_level_applied;
+
+    std::optional<spdlog::level::level_enum> toSpdlogLevel(md_log_level level)
+    {
+        switch (level)
+        {
+            case MD_LOG_LEVEL_DEBUG: return spdlog::level::debug;
+            case MD_LOG_LEVEL_INFO: return spdlog::level::info;
+            case MD_LOG_LEVEL_WARN: return spdlog::level::warn;
+            case MD_LOG_LEVEL_ERROR: return spdlog::level::err;
+            case MD_LOG_LEVEL_OFF: return spdlog::level::off;
+        }
+
+        return {};
+    }
+
+    template <class ValueType>
+    bool fitsInto(uint32_t value)
+    {
+        return value <= uint32_t{std::numeric_limits<ValueType>::max()};
+    }
+
+    std::optional<PixelFormat> toPixelFormat(md_pixel_format format)
+    {
+        switch (format)
+        {
+            case MD_PIXEL_FORMAT_RGB24: return PixelFormat::Rgb24;
+            case MD_PIXEL_FORMAT_BGR24: return PixelFormat::Bgr24;
+            case MD_PIXEL_FORMAT_RGBA32: return PixelFormat::Rgba32;
+            case MD_PIXEL_FORMAT_BGRA32: return PixelFormat::Bgra32;
+        }
+
+        return {};
+    }
+
+    std::optional<ConfigParams> toConfigParams(const md_config& config)
+    {
+        const auto are_values_in_range = fitsInto<uint16_t>(config.color_match_diff) &&
+            fitsInto<common::DimensionsType>(config.skip_front_lines) &&
+            fitsInto<common::DimensionsType>(config.skip_back_lines) &&
+            fitsInto<uint16_t>(config.duplicate_frame_diff) &&
+            fitsInto<common::DimensionsType>(config.coarse_line_stride) &&
+            fitsInto<common::DimensionsType>(config.early_exit_block) &&
+            fitsInto<uint8_t>(config.recursion_depth);
+
+        if (!are_values_in_range || config.coarse_line_stride == 0 ||
+            !(config.pixel_match_ratio > 0.) || !(config.line_match_ratio > 0.))
+        {
+            return {};
+        }
+
+        ConfigParams params;
+        params.m_minimum_pixel_match_ratio = config.pixel_match_ratio;
+        params.m_minimum_line_match_ratio = config.line_match_ratio;
+        params.m_minimum_color_match_diff = static_cast<uint16_t>(config.color_match_diff);
+        params.m_skip_front_lines = static_cast<common::DimensionsType>(config.skip_front_lines);
+        params.m_skip_back_lines = static_cast<common::DimensionsType>(config.skip_back_lines);
+        params.m_duplicate_frame_diff = static_cast<uint16_t>(config.duplicate_frame_diff);
+        params.m_coarse_line_stride = static_cast<common::DimensionsType>(config.coarse_line_stride);
+        params.m_early_exit_block = static_cast<common::DimensionsType>(config.early_exit_block);
+        params.m_recursion_depth = static_cast<uint8_t>(config.recursion_depth);
+        return params;
+    }
+
+    md_config getDefaultConfig()
+    {
+        const ConfigParams params;
+
+        md_config config{};
+        config.size = sizeof(md_config);
+        config.pixel_match_ratio = params.m_minimum_pixel_match_ratio;
+        config.line_match_ratio = params.m_minimum_line_match_ratio;
+        config.color_match_diff = params.m_minimum_color_match_diff;
+        config.skip_front_lines = params.m_skip_front_lines;
+        config.skip_back_lines = params.m_skip_back_lines;
+        config.duplicate_frame_diff = params.m_duplicate_frame_diff;
+        config.coarse_line_stride = params.m_coarse_line_stride;
+        config.early_exit_block = params.m_early_exit_block;
+        config.recursion_depth = params.m_recursion_depth;
+        config.threads = 1;
+        return config;
+    }
+
+    //! @brief Reads config of any version, fields which it does not contain are defaulted.
+    std::optional<md_config> readConfig(const md_config* config)
+    {
+        if (config == nullptr || config->size < sizeof(config->size))
+        {
+            spdlog::error("decomposer config is not initialized");
+            return {};
+        }
+
+        // fields of a newer version can be ignored only when they are not used
+        const auto* bytes = reinterpret_cast<const uint8_t*>(config);
+        if (std::any_of(bytes + std::min(config->size, sizeof(md_config)), bytes + config->size,
+            [](uint8_t byte) { return byte != 0; }))
+        {
+            spdlog::error("decomposer config contains fields unknown to this version of the library");
+            return {};
+        }
+
+        auto full_config = getDefaultConfig();
+        std::memcpy(&full_config, config, std::min(config->size, sizeof(md_config)));
+        full_config.size = sizeof(md_config);
+        return full_config;
+    }
+
+    md_status prepareBuffers(const md_frame* frames, std::size_t frame_count, std::vector<FrameBuffer>& buffers)
+    {
+        buffers.clear();
+
+        for (std::size_t i = 0; i < frame_count; i++)
+        {
+            const auto& frame = frames[i];
+            const auto& format = toPixelFormat(frame.format);
+
+            if (!format || !fitsInto<common::DimensionsType>(frame.width) || !fitsInto<common::DimensionsType>(frame.height))
+            {
+                return MD_INVALID_ARGUMENT;
+            }
+
+            FrameBuffer buffer;
+            buffer.m_data = frame.data;
+            buffer.m_width = static_cast<common::DimensionsType>(frame.width);
+            buffer.m_height = static_cast<common::DimensionsType>(frame.height);
+            buffer.m_stride = frame.stride;
+            buffer.m_format = *format;
+
+            if (!buffer.isValid())
+            {
+                return MD_INVALID_ARGUMENT;
+            }
+
+            if (!buffers.empty() && (buffers.front().m_width != buffer.m_width || buffers.front().m_height != buffer.m_height))
+            {
+                return MD_INCONSISTENT_FRAMES;
+            }
+
+            buffers.push_back(buffer);
+        }
+
+        return MD_OK;
+    }
+
+    md_status copyMosaics(const std::vector<md_mosaic>& source, md_mosaic* mosaics, std::size_t mosaic_capacity,
+        std::size_t* mosaic_count)
+    {
+        *mosaic_count = source.size();
+        std::copy_n(source.begin(), std::min(source.size(), mosaic_capacity), mosaics);
+
+        return source.size() <= mosaic_capacity ? MD_OK : MD_INSUFFICIENT_CAPACITY;
+    }
+}
+
+uint32_t md_get_api_version(void)
+{
+    return MD_API_VERSION;
+}
+
+md_status md_set_log_level(md_log_level level)
+{
+    const auto& spdlog_level = toSpdlogLevel(level);
+    if (!spdlog_level)
+    {
+        return MD_INVALID_ARGUMENT;
+    }
+
+    // level set explicitly is not overridden by the default one once a decomposer is created
+    std::call_once(is_log_level_applied, []() {});
+    spdlog::set_level(*spdlog_level);
+    return MD_OK;
+}
+
+void md_get_default_config(md_config* config)
+{
+    // config of an older version is smaller, hence only fields within its size are written
+    if (config == nullptr || config->size < sizeof(config->size))
+    {
+        return;
+    }
+
+    const auto& defaults = getDefaultConfig();
+    const auto size = std::min(config->size, sizeof(md_config));
+
+    std::memcpy(reinterpret_cast<uint8_t*>(config) + sizeof(config->size),
+        reinterpret_cast<const uint8_t*>(&defaults) + sizeof(config->size), size - sizeof(config->size));
+}
+
+md_decomposer* md_create(const md_config* config)
+{
+    const auto& full_config = readConfig(config);
+    if (!full_config)
+    {
+        return nullptr;
+    }
+
+    const auto& params = toConfigParams(*full_config);
+    if (!params)
+    {
+        spdlog::error("decomposer config contains values out of range");
+        return nullptr;
+    }
+
+    std::call_once(is_log_level_applied, []() { spdlog::set_level(DEFAULT_LOG_LEVEL); });
+
+    try
+    {
+        return new md_decomposer(*params, full_config->threads);
+    }
+    catch (const std::exception& exception)
+    {
+        spdlog::error("failed to create decomposer: {}", exception.what());
+        return nullptr;
+    }
+}
+
+void md_destroy(md_decomposer* decomposer)
+{
+    delete decomposer;
+}
+
+md_status md_decompose(md_decomposer* decomposer, const md_frame* frames, size_t frame_count,
+    md_mosaic* mosaics, size_t mosaic_capacity, size_t* mosaic_count)
+{
+    if (decomposer == nullptr || frames == nullptr || frame_count == 0 || mosaic_count == nullptr ||
+        (mosaics == nullptr && mosaic_capacity > 0))
+    {
+        return MD_INVALID_ARGUMENT;
+    }
+
+    *mosaic_count = 0;
+    decomposer->m_last_mosaics.clear();
+
+    // exceptions must not cross the C boundary
+    try
+    {
+        const auto status = prepareBuffers(frames, frame_count, decomposer->m_buffers);
+        if (status != MD_OK)
+        {
+            return status;
+        }
+
+        decomposer->m_frame_provider.assign(decomposer->m_buffers.data(), decomposer->m_buffers.size());
+
+        const auto& dimensions = decomposer->m_decomposer.calculateMosaicsDimensions();
+        if (dimensions.empty())
+        {
+            return MD_FAILURE;
+        }
+
+        for (const auto& dimension : dimensions)
+        {
+            decomposer->m_last_mosaics.push_back(md_mosaic{dimension.m_x, dimension.m_y, dimension.m_width, dimension.m_height});
+        }
+
+        return copyMosaics(decomposer->m_last_mosaics, mosaics, mosaic_capacity, mosaic_count);
+    }
+    catch (const std::exception& exception)
+    {
+        spdlog::error("decomposition failed: {}", exception.what());
+        return MD_FAILURE;
+    }
+}
+
+md_status md_get_last_mosaics(const md_decomposer* decomposer, md_mosaic* mosaics, size_t mosaic_capacity,
+    size_t* mosaic_count)
+{
+    if (decomposer == nullptr || mosaic_count == nullptr || (mosaics == nullptr && mosaic_capacity > 0))
+    {
+        return MD_INVALID_ARGUMENT;
+    }
+
+    *mosaic_count = 0;
+
+    if (decomposer->m_last_mosaics.empty())
+    {
+        return MD_FAILURE;
+    }
+
+    return copyMosaics(decomposer->m_last_mosaics, mosaics, mosaic_capacity, mosaic_count);
+}
+
+const char* md_get_status_description(md_status status)
+{
+    switch (status)
+    {
+        case MD_OK: return "success";
+        case MD_INVALID_ARGUMENT: return "invalid argument";
+        case MD_INCONSISTENT_FRAMES: return "frames have different dimensions";
+        case MD_INSUFFICIENT_CAPACITY: return "detected mosaics do not fit into the supplied array";
+        case MD_FAILURE: return "decomposition failed";
+    }
+
+    return "unknown status";
+}
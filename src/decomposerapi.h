@@ -0,0 +1,138 @@
+#pragma once
+
+/*!
+ * @brief C interface of the mosaic decomposer shared library, it's meant for applications which embed the decomposer
+ * instead of running the executable. Frames are passed in memory and no third party types cross the boundary.
+ * @note Structures are only ever extended by appending fields, md_config carries its size for that reason.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(MD_BUILDING_API)
+#define MD_API __declspec(dllexport)
+#else
+#define MD_API __declspec(dllimport)
+#endif
+#else
+#define MD_API __attribute__((visibility("default")))
+#endif
+
+#define MD_API_VERSION 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct md_decomposer md_decomposer;
+
+typedef enum md_status
+{
+    MD_OK = 0,
+    MD_INVALID_ARGUMENT = 1,
+    //! frames of a single call differ in dimensions
+    MD_INCONSISTENT_FRAMES = 2,
+    //! detected mosaics do not fit into the supplied array, required capacity is reported anyway
+    MD_INSUFFICIENT_CAPACITY = 3,
+    MD_FAILURE = 4
+} md_status;
+
+typedef enum md_pixel_format
+{
+    MD_PIXEL_FORMAT_RGB24 = 0,
+    MD_PIXEL_FORMAT_BGR24 = 1,
+    MD_PIXEL_FORMAT_RGBA32 = 2,
+    MD_PIXEL_FORMAT_BGRA32 = 3
+} md_pixel_format;
+
+typedef enum md_log_level
+{
+    MD_LOG_LEVEL_DEBUG = 0,
+    MD_LOG_LEVEL_INFO = 1,
+    MD_LOG_LEVEL_WARN = 2,
+    MD_LOG_LEVEL_ERROR = 3,
+    MD_LOG_LEVEL_OFF = 4
+} md_log_level;
+
+//! @brief Frame in a memory owned by the caller, rows are stride bytes apart.
+typedef struct md_frame
+{
+    const uint8_t* data;
+    uint32_t width;
+    uint32_t height;
+    size_t stride;
+    md_pixel_format format;
+} md_frame;
+
+typedef struct md_mosaic
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+} md_mosaic;
+
+//! @brief Subset of the decomposer's parameters, see ConfigParams for their meaning.
+//! @note size has to be set to sizeof(md_config) by the caller, then the rest is initialized by md_get_default_config().
+typedef struct md_config
+{
+    //! size of the structure the caller was compiled with, so that older and newer versions of it are recognized
+    size_t size;
+    double pixel_match_ratio;
+    double line_match_ratio;
+    uint32_t color_match_diff;
+    uint32_t skip_front_lines;
+    uint32_t skip_back_lines;
+    uint32_t duplicate_frame_diff;
+    uint32_t coarse_line_stride;
+    uint32_t early_exit_block;
+    uint32_t recursion_depth;
+    //! amount of threads used by each decomposer, 0 for all available, 1 disables the parallel analysis
+    uint32_t threads;
+} md_config;
+
+MD_API uint32_t md_get_api_version(void);
+
+/*!
+ * @brief Sets level of messages which the library logs to the standard output, it applies to all decomposers.
+ * Only warnings and errors are logged unless it's called, progress of the analysis is logged at the info level.
+ * @note available since API version 2.
+ */
+MD_API md_status md_set_log_level(md_log_level level);
+
+//! @brief Fills fields of the config with defaults, only fields within its size are written.
+MD_API void md_get_default_config(md_config* config);
+
+/*!
+ * @brief Creates decomposer out of the config. Fields missing in a config of an older version are defaulted,
+ * a config of a newer version is accepted only when its fields unknown to the library are zero.
+ * @return decomposer which has to be destroyed by md_destroy(), NULL when the config is not valid.
+ */
+MD_API md_decomposer* md_create(const md_config* config);
+
+MD_API void md_destroy(md_decomposer* decomposer);
+
+/*!
+ * @brief Decomposes given frames into mosaics. Frames are read only during the call, memory used for their analysis
+ * is kept by the decomposer and reused by the next call. A single decomposer must not be used concurrently.
+ * @param mosaic_count receives amount of detected mosaics, even when they do not fit into the array.
+ */
+MD_API md_status md_decompose(md_decomposer* decomposer, const md_frame* frames, size_t frame_count,
+    md_mosaic* mosaics, size_t mosaic_capacity, size_t* mosaic_count);
+
+/*!
+ * @brief Copies mosaics detected by the last successful md_decompose() call, so that they can be obtained
+ * after MD_INSUFFICIENT_CAPACITY without analyzing the frames again.
+ * @param mosaic_count receives amount of the mosaics, even when they do not fit into the array.
+ * @return MD_FAILURE when there was no successful decomposition yet.
+ * @note available since API version 2.
+ */
+MD_API md_status md_get_last_mosaics(const md_decomposer* decomposer, md_mosaic* mosaics, size_t mosaic_capacity,
+    size_t* mosaic_count);
+
+MD_API const char* md_get_status_description(md_status status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "decomposerapi.h"
+
+namespace md
+{
+    using Config = md_config;
+    using FrameView = md_frame;
+    using Mosaic = md_mosaic;
+
+    inline Config defaultConfig()
+    {
+        Config config{};
+        config.size = sizeof(Config);
+        md_get_default_config(&config);
+        return config;
+    }
+
+    //! @brief Sets level of messages logged by all decomposers, see md_set_log_level().
+    //! @throws std::invalid_argument when the level is not known.
+    inline void setLogLevel(md_log_level level)
+    {
+        if (md_set_log_level(level) != MD_OK)
+        {
+            throw std::invalid_argument("log level is not valid");
+        }
+    }
+
+    /**
+     * @brief C++ wrapper of the C interface of the shared library. It's header only, so that only the C interface
+     * crosses the library boundary and applications don't depend on the compiler the library was built with.
+     */
+    class Decomposer
+    {
+    public:
+        //! @throws std::invalid_argument when the config is not valid.
+        explicit Decomposer(const Config& config = defaultConfig()) :
+            m_decomposer(md_create(&config), &md_destroy)
+        {
+            if (!m_decomposer)
+            {
+                throw std::invalid_argument("decomposer config is not valid");
+            }
+        }
+
+        //! @brief Decomposes frames into mosaics, memory of the returned container is reused by the next call.
+        //! @return status of the decomposition, mosaics are valid only when it's MD_OK.
+        md_status decompose(const std::vector<FrameView>& frames, std::vector<Mosaic>& mosaics)
+        {
+            // mosaics which do not fit are copied out of the decomposer afterwards, without analyzing frames again
+            constexpr std::size_t INITIAL_CAPACITY = 64;
+
+            std::size_t mosaic_count = 0;
+            mosaics.resize(std::max(mosaics.capacity(), INITIAL_CAPACITY));
+
+            auto status = md_decompose(m_decomposer.get(), frames.data(), frames.size(),
+                mosaics.data(), mosaics.size(), &mosaic_count);
+
+            if (status == MD_INSUFFICIENT_CAPACITY)
+            {
+                mosaics.resize(mosaic_count);
+                status = md_get_last_mosaics(m_decomposer.get(), mosaics.data(), mosaics.size(), &mosaic_count);
+            }
+
+            mosaics.resize(status == MD_OK ? mosaic_count : 0);
+            return status;
+        }
+
+    private:
+        std::unique_ptr<md_decomposer, decltype(&md_destroy)> m_decomposer;
+    };
+}
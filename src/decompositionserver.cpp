@@ -0,0 +1,541 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#include "decompositionserver.h"
+#include "layout.h"
+
+namespace
+{
+    constexpr int ACCEPT_POLL_INTERVAL_MS = 100;
+    constexpr std::size_t MAXIMUM_REQUEST_LENGTH = 4096;
+
+    using Clock = std::chrono::steady_clock;
+    using OptionParser = std::function<bool(DecompositionJob& job, const std::string& value)>;
+
+    template <class ValueType>
+    bool parseUnsigned(const std::string& text, ValueType& value)
+    {
+        // only digits are accepted, so that negative values are not wrapped around
+        if (text.empty() || text.size() > 10 || text.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+
+        const auto parsed_value = std::stoull(text);
+        if (parsed_value > std::numeric_limits<ValueType>::max())
+        {
+            return false;
+        }
+
+        value = static_cast<ValueType>(parsed_value);
+        return true;
+    }
+
+    template <class ValueType>
+    OptionParser unsignedOption(ValueType ConfigParams::* parameter)
+    {
+        return [parameter](DecompositionJob& job, const std::string& value)
+        {
+            return parseUnsigned(value, job.m_params.*parameter);
+        };
+    }
+
+    OptionParser ratioOption(double ConfigParams::* parameter)
+    {
+        return [parameter](DecompositionJob& job, const std::string& value)
+        {
+            std::istringstream stream(value);
+            double ratio = 0.;
+            if (!(stream >> ratio) || !stream.eof() || !(ratio > 0.))
+            {
+                return false;
+            }
+
+            job.m_params.*parameter = ratio;
+            return true;
+        };
+    }
+
+    const std::map<std::string, OptionParser>& getOptionParsers()
+    {
+        static const std::map<std::string, OptionParser> parsers{
+            {"frames", unsignedOption(&ConfigParams::m_frames_to_analyze)},
+            {"start-frame", unsignedOption(&ConfigParams::m_start_frame)},
+            {"skip-front-lines", unsignedOption(&ConfigParams::m_skip_front_lines)},
+            {"skip-back-lines", unsignedOption(&ConfigParams::m_skip_back_lines)},
+            {"pixel-match", ratioOption(&ConfigParams::m_minimum_pixel_match_ratio)},
+            {"color-match", unsignedOption(&ConfigParams::m_minimum_color_match_diff)},
+            {"line-match", ratioOption(&ConfigParams::m_minimum_line_match_ratio)},
+            {"skip-duplicates", unsignedOption(&ConfigParams::m_duplicate_frame_diff)},
+            {"incremental", [](DecompositionJob& job, const std::string& value)
+            {
+                job.m_params.m_incremental_analysis = value == "1";
+                return value == "0" || value == "1";
+            }},
+            {"coarse-stride", unsignedOption(&ConfigParams::m_coarse_line_stride)},
+            {"refine-radius", unsignedOption(&ConfigParams::m_refine_radius)},
+            {"early-exit", unsignedOption(&ConfigParams::m_early_exit_block)},
+            {"recursion", unsignedOption(&ConfigParams::m_recursion_depth)},
+            {"recursion-frames", unsignedOption(&ConfigParams::m_recursion_frames)},
+            {"recursion-size", unsignedOption(&ConfigParams::m_minimum_recursive_size)},
+            {"timeout", [](DecompositionJob& job, const std::string& value)
+            {
+                uint32_t timeout = 0;
+                if (!parseUnsigned(value, timeout))
+                {
+                    return false;
+                }
+
+                job.m_timeout = std::chrono::milliseconds(timeout);
+                return true;
+            }}
+        };
+
+        return parsers;
+    }
+
+    bool sendAll(int socket, const std::string& data)
+    {
+        std::size_t sent_bytes = 0;
+        while (sent_bytes < data.size())
+        {
+            // client may disconnect at any time, which must not raise SIGPIPE
+            const auto result = send(socket, data.data() + sent_bytes, data.size() - sent_bytes, MSG_NOSIGNAL);
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            if (result <= 0)
+            {
+                return false;
+            }
+
+            sent_bytes += static_cast<std::size_t>(result);
+        }
+
+        return true;
+    }
+}
+
+DecompositionServer::DecompositionServer(const ServerParams& params, FrameProviderFactory frame_provider_factory) :
+    m_params(params),
+    m_frame_provider_factory(std::move(frame_provider_factory))
+{
+}
+
+DecompositionServer::~DecompositionServer()
+{
+    stop();
+}
+
+bool DecompositionServer::start()
+{
+    if (m_socket >= 0)
+    {
+        spdlog::error("server is already started");
+        return false;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    const auto& path = m_params.m_socket_path;
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+    {
+        spdlog::error("socket path {} is either empty or too long", path);
+        return false;
+    }
+
+    std::copy(path.begin(), path.end(), address.sun_path);
+
+    m_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_socket < 0)
+    {
+        spdlog::error("failed to create socket: {}", std::strerror(errno));
+        return false;
+    }
+
+    unlink(path.c_str());
+
+    if (bind(m_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(m_socket, SOMAXCONN) != 0)
+    {
+        spdlog::error("failed to listen on {}: {}", path, std::strerror(errno));
+        close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+
+    auto worker_count = m_params.m_worker_count;
+    if (worker_count == 0)
+    {
+        // a worker per cpu of the placement, so that none of them is oversubscribed nor left idle
+        for (const auto& cpus : m_params.m_worker_cpus)
+        {
+            worker_count += cpus.size();
+        }
+    }
+
+    if (worker_count == 0)
+    {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_statistics.m_worker_count = worker_count;
+    for (std::size_t i = 0; i < worker_count; i++)
+    {
+        auto& worker = m_workers.emplace_back(&DecompositionServer::runWorker, this);
+
+        if (!m_params.m_worker_cpus.empty())
+        {
+            topology::pinThread(worker, m_params.m_worker_cpus[i % m_params.m_worker_cpus.size()]);
+        }
+    }
+
+    m_accept_thread = std::thread(&DecompositionServer::acceptConnections, this);
+
+    spdlog::info("listening on {} with {} workers", path, worker_count);
+    return true;
+}
+
+void DecompositionServer::stop()
+{
+    {
+        // jobs are submitted under the same lock, so none of them can be queued after the workers leave
+        std::lock_guard<std::mutex> lock(m_jobs_mutex);
+        if (m_stopping || m_socket < 0)
+        {
+            return;
+        }
+
+        m_stopping = true;
+    }
+
+    m_jobs_condition.notify_all();
+    m_accept_thread.join();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+
+    std::lock_guard<std::mutex> lock(m_connections_mutex);
+    for (auto& connection : m_connections)
+    {
+        shutdown(connection->m_socket, SHUT_RDWR);
+    }
+
+    for (auto& connection : m_connections)
+    {
+        connection->m_thread.join();
+        close(connection->m_socket);
+    }
+    m_connections.clear();
+
+    close(m_socket);
+    unlink(m_params.m_socket_path.c_str());
+
+    spdlog::info("stopped listening on {}", m_params.m_socket_path);
+}
+
+ServerStatistics DecompositionServer::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_jobs_mutex);
+
+    auto statistics = m_statistics;
+    statistics.m_queued_jobs = m_jobs.size();
+    return statistics;
+}
+
+std::optional<DecompositionJob> DecompositionServer::parseJob(const std::string& request, std::string& error)
+{
+    std::istringstream stream(request);
+    std::string command;
+    std::string input_type;
+    DecompositionJob job;
+
+    if (!(stream >> command >> input_type >> job.m_file_path) || command != "decompose" ||
+        (input_type != "video" && input_type != "image"))
+    {
+        error = "expected: decompose (video | image) <file-path> [<option>=<value>...]";
+        return {};
+    }
+
+    job.m_is_video = input_type == "video";
+
+    std::string option;
+    while (stream >> option)
+    {
+        const auto separator = option.find('=');
+        const auto& parsers = getOptionParsers();
+        const auto parser = parsers.find(option.substr(0, separator));
+
+        if (separator == std::string::npos || parser == parsers.end())
+        {
+            error = "unknown option " + option;
+            return {};
+        }
+
+        if (!parser->second(job, option.substr(separator + 1)))
+        {
+            error = "invalid value of option " + option;
+            return {};
+        }
+    }
+
+    return job;
+}
+
+void DecompositionServer::acceptConnections()
+{
+    while (!m_stopping)
+    {
+        pollfd descriptor{m_socket, POLLIN, 0};
+        const auto result = poll(&descriptor, 1, ACCEPT_POLL_INTERVAL_MS);
+
+        closeFinishedConnections();
+
+        if (result <= 0)
+        {
+            continue;
+        }
+
+        const auto client_socket = accept4(m_socket, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_socket < 0)
+        {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        auto& connection = *m_connections.emplace_back(std::make_unique<Connection>());
+        connection.m_socket = client_socket;
+        connection.m_thread = std::thread(&DecompositionServer::serveConnection, this, std::ref(connection));
+    }
+}
+
+void DecompositionServer::closeFinishedConnections()
+{
+    std::lock_guard<std::mutex> lock(m_connections_mutex);
+
+    const auto finished = std::stable_partition(m_connections.begin(), m_connections.end(),
+        [](const std::unique_ptr<Connection>& connection) { return !connection->m_is_finished; });
+
+    for (auto it = finished; it != m_connections.end(); it++)
+    {
+        (*it)->m_thread.join();
+        close((*it)->m_socket);
+    }
+
+    m_connections.erase(finished, m_connections.end());
+}
+
+void DecompositionServer::serveConnection(Connection& connection)
+{
+    std::string received_data;
+    std::vector<char> buffer(1024);
+
+    while (!m_stopping)
+    {
+        const auto line_end = received_data.find('\n');
+        if (line_end == std::string::npos)
+        {
+            if (received_data.size() > MAXIMUM_REQUEST_LENGTH)
+            {
+                sendAll(connection.m_socket, "error request is too long\n");
+                break;
+            }
+
+            const auto received_bytes = recv(connection.m_socket, buffer.data(), buffer.size(), 0);
+            if (received_bytes < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            if (received_bytes <= 0)
+            {
+                break;
+            }
+
+            received_data.append(buffer.data(), static_cast<std::size_t>(received_bytes));
+            continue;
+        }
+
+        auto request = received_data.substr(0, line_end);
+        received_data.erase(0, line_end + 1);
+
+        if (!request.empty() && request.back() == '\r')
+        {
+            request.pop_back();
+        }
+
+        if (!sendAll(connection.m_socket, handleRequest(request) + '\n'))
+        {
+            break;
+        }
+    }
+
+    connection.m_is_finished = true;
+}
+
+std::string DecompositionServer::handleRequest(const std::string& request)
+{
+    if (request == "health")
+    {
+        return "ok";
+    }
+
+    if (request == "stats")
+    {
+        const auto& statistics = getStatistics();
+
+        std::ostringstream response;
+        response << "ok completed=" << statistics.m_completed_jobs << " failed=" << statistics.m_failed_jobs <<
+            " rejected=" << statistics.m_rejected_jobs << " timed_out=" << statistics.m_timed_out_jobs <<
+            " queued=" << statistics.m_queued_jobs << " running=" << statistics.m_running_jobs <<
+            " workers=" << statistics.m_worker_count;
+        return response.str();
+    }
+
+    std::string error;
+    auto job = parseJob(request, error);
+    if (!job)
+    {
+        return "error " + error;
+    }
+
+    return submitJob(std::move(*job));
+}
+
+std::string DecompositionServer::submitJob(DecompositionJob job)
+{
+    const auto timeout = job.m_timeout.count() > 0 ? job.m_timeout : m_params.m_default_timeout;
+
+    auto pending_job = std::make_shared<PendingJob>();
+    pending_job->m_job = std::move(job);
+    pending_job->m_deadline = timeout.count() > 0 ? Clock::now() + timeout : Clock::time_point::max();
+
+    auto response = pending_job->m_response.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(m_jobs_mutex);
+        if (m_stopping)
+        {
+            return "error server is stopping";
+        }
+
+        // client is expected to retry later, which keeps the latency of accepted jobs bounded
+        if (m_jobs.size() >= m_params.m_max_queued_jobs)
+        {
+            m_statistics.m_rejected_jobs++;
+            return "error busy";
+        }
+
+        m_jobs.push(pending_job);
+    }
+
+    m_jobs_condition.notify_one();
+    return response.get();
+}
+
+void DecompositionServer::runWorker()
+{
+    // frames of batches stay allocated between jobs of the worker
+    const auto batches = std::make_shared<MosaicDecomposer::BatchStorage>();
+
+    while (true)
+    {
+        std::shared_ptr<PendingJob> pending_job;
+        {
+            std::unique_lock<std::mutex> lock(m_jobs_mutex);
+            m_jobs_condition.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+
+            if (m_jobs.empty())
+            {
+                return;
+            }
+
+            pending_job = m_jobs.front();
+            m_jobs.pop();
+            m_statistics.m_running_jobs++;
+        }
+
+        auto outcome = JobOutcome::Failed;
+        const auto& response = m_stopping ? "error server is stopping" : runJob(*pending_job, batches, outcome);
+
+        {
+            std::lock_guard<std::mutex> lock(m_jobs_mutex);
+            m_statistics.m_running_jobs--;
+            m_statistics.m_completed_jobs += outcome == JobOutcome::Completed;
+            m_statistics.m_failed_jobs += outcome == JobOutcome::Failed;
+            m_statistics.m_timed_out_jobs += outcome == JobOutcome::TimedOut;
+        }
+
+        pending_job->m_response.set_value(response);
+    }
+}
+
+std::string DecompositionServer::runJob(const PendingJob& pending_job,
+    const std::shared_ptr<MosaicDecomposer::BatchStorage>& batches, JobOutcome& outcome)
+{
+    const auto& job = pending_job.m_job;
+
+    outcome = JobOutcome::TimedOut;
+    if (Clock::now() >= pending_job.m_deadline)
+    {
+        return "error timeout";
+    }
+
+    outcome = JobOutcome::Failed;
+
+    try
+    {
+        const auto& frame_provider = m_frame_provider_factory(job);
+        if (!frame_provider || !frame_provider->isReady())
+        {
+            return "error input " + job.m_file_path + " cannot be read";
+        }
+
+        MosaicDecomposer::RunOptions run_options;
+        run_options.m_deadline = pending_job.m_deadline;
+        run_options.m_cancellation = &m_stopping;
+
+        MosaicDecomposer decomposer(*frame_provider, job.m_params);
+        decomposer.setBatchStorage(batches);
+
+        const auto& result = decomposer.decompose(run_options);
+        if (result.m_is_interrupted && m_stopping)
+        {
+            return "error server is stopping";
+        }
+
+        if (result.m_dimensions.empty())
+        {
+            outcome = result.m_is_interrupted ? JobOutcome::TimedOut : JobOutcome::Failed;
+            return result.m_is_interrupted ? "error timeout" : "error decomposition failed";
+        }
+
+        // layout of the frames analyzed until the deadline is still returned, along with its confidence
+        outcome = result.m_is_interrupted ? JobOutcome::TimedOut : JobOutcome::Completed;
+        return fmt::format("ok {} interrupted={} frames={} margin={:.2f}/{:.2f}", layout::toString(result.m_dimensions),
+            result.m_is_interrupted ? 1 : 0, result.m_processed_frames, result.m_margins.m_weakest_accepted,
+            result.m_margins.m_strongest_dropped);
+    }
+    catch (const std::exception& exception)
+    {
+        spdlog::error("job of {} failed: {}", job.m_file_path, exception.what());
+        return std::string("error ") + exception.what();
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "configparams.h"
+#include "frameproviderinterface.h"
+#include "mosaicdecomposer.h"
+#include "topology.h"
+
+struct ServerParams
+{
+    std::string m_socket_path;
+
+    //! @brief Amount of workers which run jobs concurrently, 0 means amount of cpus which workers are pinned to,
+    //! or amount of hardware threads when they are not pinned.
+    std::size_t m_worker_count = 0;
+
+    //! @brief Amount of jobs waiting for a worker, further jobs are rejected until some of them are taken.
+    std::size_t m_max_queued_jobs = 16;
+
+    //! @brief Timeout of jobs which don't specify their own one, it includes time spent in the queue. 0 disables it.
+    std::chrono::milliseconds m_default_timeout{0};
+
+    //! @brief Cpus which workers are pinned to in round robin order, so that a job is decoded and analyzed on
+    //! a single node. Empty means that workers are not pinned.
+    std::vector<topology::CpuList> m_worker_cpus;
+};
+
+struct DecompositionJob
+{
+    std::string m_file_path;
+    bool m_is_video = true;
+    ConfigParams m_params;
+    std::chrono::milliseconds m_timeout{0};
+};
+
+struct ServerStatistics
+{
+    uint64_t m_completed_jobs = 0;
+    uint64_t m_failed_jobs = 0;
+    uint64_t m_rejected_jobs = 0;
+    //! @brief Jobs which reached their timeout, including the ones responded with an interrupted layout.
+    uint64_t m_timed_out_jobs = 0;
+    std::size_t m_queued_jobs = 0;
+    std::size_t m_running_jobs = 0;
+    std::size_t m_worker_count = 0;
+};
+
+/**
+ * @brief Serves decompositions over a Unix domain socket, so that clients don't pay for the process startup.
+ * Protocol is line based, each request gets a single response line, either "ok ..." or "error <reason>":
+ *  - "decompose (video | image) <file-path> [<option>=<value>...]" responds with
+ *    "ok <layout> interrupted=(0 | 1) frames=<analyzed-frames> margin=<weakest-accepted>/<strongest-dropped>",
+ *    options are named the same as the command line ones (e.g. pixel-match=1.4) plus timeout=<milliseconds>.
+ *    Once the timeout passes, layout of the frames analyzed so far is responded as interrupted, jobs which time out
+ *    while still queued respond with "error timeout",
+ *  - "health" responds with "ok",
+ *  - "stats" responds with "ok <statistic>=<value>..." of all ServerStatistics.
+ * Requests of a single connection are handled one after another, connections are handled concurrently.
+ */
+class DecompositionServer
+{
+public:
+    //! @brief Creates frame provider of the job's input, nullptr when it can't be opened.
+    using FrameProviderFactory = std::function<std::unique_ptr<FrameProviderInterface>(const DecompositionJob& job)>;
+
+    DecompositionServer(const ServerParams& params, FrameProviderFactory frame_provider_factory);
+    ~DecompositionServer();
+
+    DecompositionServer(const DecompositionServer&) = delete;
+    DecompositionServer& operator=(const DecompositionServer&) = delete;
+
+    //! @brief Binds the socket and starts accepting connections, an existing socket file is replaced.
+    bool start();
+
+    //! @brief Stops accepting connections, closes the open ones and cancels pending jobs.
+    void stop();
+
+    ServerStatistics getStatistics() const;
+
+    //! @brief Parses "decompose" request, error is a reason of the failure when it's not valid.
+    static std::optional<DecompositionJob> parseJob(const std::string& request, std::string& error);
+
+private:
+    enum class JobOutcome
+    {
+        Completed,
+        Failed,
+        TimedOut
+    };
+
+    struct PendingJob
+    {
+        DecompositionJob m_job;
+        std::chrono::steady_clock::time_point m_deadline;
+        std::promise<std::string> m_response;
+    };
+
+    struct Connection
+    {
+        int m_socket = -1;
+        std::thread m_thread;
+        std::atomic<bool> m_is_finished{false};
+    };
+
+    void acceptConnections();
+    void serveConnection(Connection& connection);
+    std::string handleRequest(const std::string& request);
+    std::string submitJob(DecompositionJob job);
+    void runWorker();
+    std::string runJob(const PendingJob& pending_job, const std::shared_ptr<MosaicDecomposer::BatchStorage>& batches,
+        JobOutcome& outcome);
+    void closeFinishedConnections();
+
+    const ServerParams m_params;
+    const FrameProviderFactory m_frame_provider_factory;
+
+    int m_socket = -1;
+    std::atomic<bool> m_stopping{false};
+    std::thread m_accept_thread;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_connections_mutex;
+    std::vector<std::unique_ptr<Connection>> m_connections;
+
+    mutable std::mutex m_jobs_mutex;
+    std::condition_variable m_jobs_condition;
+    std::queue<std::shared_ptr<PendingJob>> m_jobs;
+    ServerStatistics m_statistics;
+};
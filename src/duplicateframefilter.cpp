@@ -0,0 +1,86 @@
+#include <array>
+
+#include "duplicateframefilter.h"
+
+namespace
+{
+    // amount of sampled pixels per each dimension of a thumbnail cell
+    constexpr unsigned CELL_SAMPLES = 4;
+    constexpr unsigned SAMPLES_PER_DIMENSION = FrameSignature::THUMBNAIL_SIZE * CELL_SAMPLES;
+
+    // samples are spread evenly across the dimension, positions repeat when the frame is smaller than the grid
+    Frame::DimensionsType samplePosition(unsigned sample, Frame::DimensionsType length)
+    {
+        return static_cast<Frame::DimensionsType>((2 * sample + 1) * length / (2 * SAMPLES_PER_DIMENSION));
+    }
+}
+
+FrameSignature::FrameSignature(const Frame& frame) :
+    m_thumbnail(CELL_COUNT)
+{
+    const auto width = frame.getWidth();
+    const auto height = frame.getHeight();
+
+    if (width == 0 || height == 0)
+    {
+        return;
+    }
+
+    for (unsigned cell_x = 0; cell_x < THUMBNAIL_SIZE; cell_x++)
+    {
+        for (unsigned cell_y = 0; cell_y < THUMBNAIL_SIZE; cell_y++)
+        {
+            std::array<unsigned, 3> sum{};
+
+            for (unsigned sample_x = cell_x * CELL_SAMPLES; sample_x < (cell_x + 1) * CELL_SAMPLES; sample_x++)
+            {
+                for (unsigned sample_y = cell_y * CELL_SAMPLES; sample_y < (cell_y + 1) * CELL_SAMPLES; sample_y++)
+                {
+                    const auto pixel = frame.get(samplePosition(sample_x, width), samplePosition(sample_y, height));
+                    sum[0] += pixel.m_red;
+                    sum[1] += pixel.m_green;
+                    sum[2] += pixel.m_blue;
+                }
+            }
+
+            constexpr auto SAMPLES_PER_CELL = CELL_SAMPLES * CELL_SAMPLES;
+            m_thumbnail[cell_x * THUMBNAIL_SIZE + cell_y] = Pixel{static_cast<Pixel::Color>(sum[0] / SAMPLES_PER_CELL),
+                static_cast<Pixel::Color>(sum[1] / SAMPLES_PER_CELL),
+                static_cast<Pixel::Color>(sum[2] / SAMPLES_PER_CELL)};
+        }
+    }
+}
+
+uint32_t FrameSignature::getDifference(const FrameSignature& other) const
+{
+    uint32_t difference = 0;
+    for (std::size_t i = 0; i < CELL_COUNT; i++)
+    {
+        difference += m_thumbnail[i].colorDifference(other.m_thumbnail[i]);
+    }
+
+    return difference;
+}
+
+DuplicateFrameFilter::DuplicateFrameFilter(uint16_t maximum_color_diff) :
+    m_maximum_color_diff(maximum_color_diff)
+{
+}
+
+bool DuplicateFrameFilter::isDuplicate(const Frame& frame)
+{
+    if (m_maximum_color_diff == 0)
+    {
+        return false;
+    }
+
+    FrameSignature signature(frame);
+
+    if (m_last_signature && signature.getDifference(*m_last_signature) < m_maximum_color_diff * FrameSignature::CELL_COUNT)
+    {
+        return true;
+    }
+
+    m_last_signature = std::move(signature);
+    return false;
+}
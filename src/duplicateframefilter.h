@@ -0,0 +1,43 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+#include <cstdint>
+
+#include "frame.h"
+
+/*!
+ * @brief Cheap signature of a frame, i.e. a downscaled thumbnail whose cells are averages of sampled pixels.
+ */
+class FrameSignature
+{
+public:
+    static constexpr Frame::DimensionsType THUMBNAIL_SIZE = 16;
+    static constexpr std::size_t CELL_COUNT = THUMBNAIL_SIZE * THUMBNAIL_SIZE;
+
+    explicit FrameSignature(const Frame& frame);
+
+    //! @brief Calculates sum of color differences of all thumbnail cells.
+    uint32_t getDifference(const FrameSignature& other) const;
+
+private:
+    std::vector<Pixel> m_thumbnail;
+};
+
+/*!
+ * @brief Recognizes frames which are near-duplicates of the last accepted one, e.g. static parts of a video.
+ */
+class DuplicateFrameFilter
+{
+public:
+    //! @param maximum_color_diff average color difference of thumbnail cells below which the frame is considered
+    //! as a duplicate, 0 disables the filter.
+    explicit DuplicateFrameFilter(uint16_t maximum_color_diff);
+
+    //! @brief Checks whether frame is a duplicate of the last accepted frame, it becomes the last accepted one otherwise.
+    bool isDuplicate(const Frame& frame);
+
+private:
+    const uint16_t m_maximum_color_diff;
+    std::optional<FrameSignature> m_last_signature;
+};
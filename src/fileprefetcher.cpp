@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <fstream>
+
+#include <spdlog/spdlog.h>
+
+#include "fileprefetcher.h"
+
+FilePrefetcher::FilePrefetcher(std::vector<std::string> file_paths, std::size_t read_ahead) :
+    m_file_paths(std::move(file_paths))
+{
+    read_ahead = std::max<std::size_t>(read_ahead, 1);
+
+    // one more slot holds the file which is being consumed
+    m_slots.resize(read_ahead + 1);
+
+    for (std::size_t i = 0; i < std::min(read_ahead, m_file_paths.size()); i++)
+    {
+        m_readers.emplace_back(&FilePrefetcher::read, this);
+    }
+}
+
+FilePrefetcher::~FilePrefetcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_condition.notify_all();
+
+    for (auto& reader : m_readers)
+    {
+        reader.join();
+    }
+}
+
+const FilePrefetcher::FileBuffer* FilePrefetcher::next()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // slot of the previously provided file can be used for reading ahead again
+    if (m_released_files < m_next_consumed_file)
+    {
+        m_slots[m_released_files % m_slots.size()].m_is_ready = false;
+        m_released_files = m_next_consumed_file;
+        m_condition.notify_all();
+    }
+
+    if (m_next_consumed_file == m_file_paths.size())
+    {
+        return nullptr;
+    }
+
+    auto& slot = m_slots[m_next_consumed_file % m_slots.size()];
+    m_condition.wait(lock, [&slot]() { return slot.m_is_ready; });
+
+    m_next_consumed_file++;
+    return &slot.m_buffer;
+}
+
+std::size_t FilePrefetcher::getFileCount() const
+{
+    return m_file_paths.size();
+}
+
+void FilePrefetcher::read()
+{
+    while (true)
+    {
+        std::size_t file_index = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]()
+            {
+                return m_stopping || m_next_unread_file == m_file_paths.size() ||
+                    m_next_unread_file < m_released_files + m_slots.size();
+            });
+
+            if (m_stopping || m_next_unread_file == m_file_paths.size())
+            {
+                return;
+            }
+
+            file_index = m_next_unread_file++;
+        }
+
+        // slot is not accessed by anyone else until it's marked as ready
+        auto& slot = m_slots[file_index % m_slots.size()];
+        slot.m_buffer.m_path = m_file_paths[file_index];
+        readFile(slot.m_buffer);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            slot.m_is_ready = true;
+        }
+
+        m_condition.notify_all();
+    }
+}
+
+void FilePrefetcher::readFile(FileBuffer& buffer)
+{
+    buffer.m_is_read = false;
+    buffer.m_data.clear();
+
+    std::ifstream file(buffer.m_path, std::ios::binary | std::ios::ate);
+    const auto size = file.tellg();
+
+    if (!file || size < 0)
+    {
+        spdlog::error("file {} cannot be opened", buffer.m_path);
+        return;
+    }
+
+    // capacity of the buffer is kept, so it's reallocated only when the file is bigger than the previous ones
+    buffer.m_data.resize(static_cast<std::size_t>(size));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(buffer.m_data.data()), size);
+
+    if (file.fail())
+    {
+        spdlog::error("file {} cannot be read", buffer.m_path);
+        buffer.m_data.clear();
+        return;
+    }
+
+    buffer.m_is_read = true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Reads files ahead of their consumption into reusable buffers, so that decoding of the current file
+ * overlaps with waiting on the storage for the next ones. Files are read by dedicated threads, each of them
+ * reads a single file at once, so that latency of network mounted or spinning storage is hidden as well.
+ */
+class FilePrefetcher
+{
+public:
+    struct FileBuffer
+    {
+        std::string m_path;
+        std::vector<uint8_t> m_data;
+        //! @brief Whether the whole file was read, data is empty otherwise.
+        bool m_is_read = false;
+    };
+
+    //! @param read_ahead amount of files read ahead of the consumed one, it's also amount of reading threads.
+    FilePrefetcher(std::vector<std::string> file_paths, std::size_t read_ahead);
+    ~FilePrefetcher();
+
+    FilePrefetcher(const FilePrefetcher&) = delete;
+    FilePrefetcher& operator=(const FilePrefetcher&) = delete;
+
+    //! @brief Provides the next file in order of the paths, blocks until it's read.
+    //! @note buffer stays valid until the next call, its memory is reused for one of the following files then.
+    //! @return nullptr when all files were provided.
+    const FileBuffer* next();
+
+    std::size_t getFileCount() const;
+
+private:
+    struct Slot
+    {
+        FileBuffer m_buffer;
+        bool m_is_ready = false;
+    };
+
+    void read();
+    static void readFile(FileBuffer& buffer);
+
+    const std::vector<std::string> m_file_paths;
+
+    // file at a given index is read into the slot at the index modulo amount of slots
+    std::vector<Slot> m_slots;
+    std::size_t m_next_unread_file = 0;
+    std::size_t m_next_consumed_file = 0;
+    std::size_t m_released_files = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping = false;
+    std::vector<std::thread> m_readers;
+};
@@ -6,22 +6,60 @@
 
 Frame::Frame(DimensionsType width, DimensionsType height): 
     m_pixels(std::make_shared<PixelContainer>(width, std::vector<Pixel>(height))),
-    m_owns_content(true)
+    m_owns_content(true),
+    m_width(width),
+    m_height(height)
 {
 }
 
 Frame::Frame(const Frame& other) : 
     m_pixels(other.m_pixels), 
     m_owns_content(false), 
-    m_transposition(other.m_transposition)
+    m_transposition(other.m_transposition),
+    m_offset_x(other.m_offset_x),
+    m_offset_y(other.m_offset_y),
+    m_width(other.m_width),
+    m_height(other.m_height)
 {
 }
 
+Frame& Frame::operator=(const Frame& other)
+{
+    m_pixels = other.m_pixels;
+    m_owns_content = false;
+    m_transposition = other.m_transposition;
+    m_offset_x = other.m_offset_x;
+    m_offset_y = other.m_offset_y;
+    m_width = other.m_width;
+    m_height = other.m_height;
+
+    return *this;
+}
+
+void Frame::reuse(DimensionsType width, DimensionsType height)
+{
+    const auto is_storage_reusable = m_pixels.use_count() == 1 && width > 0 && 
+        get().size() == width && get()[0].size() == height;
+
+    m_transposition = Transposition::None;
+    m_owns_content = true;
+    m_offset_x = 0;
+    m_offset_y = 0;
+    m_width = width;
+    m_height = height;
+
+    if (is_storage_reusable)
+    {
+        return;
+    }
+
+    m_pixels = std::make_shared<PixelContainer>(width, std::vector<Pixel>(height));
+}
+
 Frame::Frame(const Frame& other, Transposition transposition) : 
-    m_pixels(other.m_pixels), 
-    m_owns_content(false), 
-    m_transposition(transposition) 
+    Frame(other)
 {
+    m_transposition = transposition;
 }
 
 Frame Frame::rotate90() const
@@ -35,6 +73,34 @@ Frame Frame::rotate90() const
     return transposed;
 }
 
+Frame Frame::crop(DimensionsType x, DimensionsType y, DimensionsType width, DimensionsType height) const
+{
+    if (x + width > getWidth() || y + height > getHeight())
+    {
+        throw std::runtime_error("Cropped region exceeds the frame");
+    }
+
+    Frame cropped(*this);
+
+    if (m_transposition == Transposition::Rotated90)
+    {
+        // region of the rotated view is mapped to the region of the storage, see transpose()
+        cropped.m_offset_x = static_cast<DimensionsType>(m_offset_x + y);
+        cropped.m_offset_y = static_cast<DimensionsType>(m_offset_y + m_height - x - width);
+        cropped.m_width = height;
+        cropped.m_height = width;
+    }
+    else
+    {
+        cropped.m_offset_x = static_cast<DimensionsType>(m_offset_x + x);
+        cropped.m_offset_y = static_cast<DimensionsType>(m_offset_y + y);
+        cropped.m_width = width;
+        cropped.m_height = height;
+    }
+
+    return cropped;
+}
+
 void Frame::set(DimensionsType x, DimensionsType y, const Pixel& pixel)
 {
     auto [tx, ty] = transpose(x, y);
@@ -72,7 +138,7 @@ void Frame::set(DimensionsType x, DimensionsType y, const Pixel& pixel)
         m_owns_content = true;
     }
 
-    get()[tx][ty] = pixel;
+    get()[m_offset_x + tx][m_offset_y + ty] = pixel;
 }
 
 Frame::PixelContainer& Frame::get()
@@ -99,7 +165,7 @@ Pixel Frame::get(DimensionsType x, DimensionsType y) const
         spdlog::error("failed to get pixel for y={}, frame height is={}", y, getHeight());
     }
 
-    return get()[tx][ty];
+    return get()[m_offset_x + tx][m_offset_y + ty];
 }
 
 Frame::DimensionsType Frame::getWidth() const 
@@ -122,12 +188,12 @@ Frame::DimensionsType Frame::getHeight() const
 
 Frame::DimensionsType Frame::getActualHeight() const
 {
-    return static_cast<DimensionsType>(get()[0].size());
+    return m_height;
 }
 
 Frame::DimensionsType Frame::getActualWidth() const
 {
-    return static_cast<DimensionsType>(get().size());
+    return m_width;
 }
 
 std::pair<Frame::DimensionsType, Frame::DimensionsType> Frame::transpose(DimensionsType x, DimensionsType y) const
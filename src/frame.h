@@ -11,6 +11,7 @@
  * @brief Defines two dimensional array which maintains pixels of a frame.
  * @note it utilizes implicit sharing to avoid deep copies, 
  * however it detaches when modifications are performed on the copied object.
+ * Frame can be also a view of a rectangular region of another frame, it shares its pixels as any other copy.
  */
 class Frame
 {
@@ -20,15 +21,31 @@ public:
 
     Frame(DimensionsType width, DimensionsType height);
     Frame(const Frame& other);
+    Frame& operator=(const Frame& other);
+
+    //! @brief Prepares frame to be overwritten with a content of given dimensions, 
+    //! already allocated memory is reused when it's not shared with other frames and dimensions match.
+    void reuse(DimensionsType width, DimensionsType height);
 
     Frame rotate90() const;
 
+    //! @brief Creates view of a region of the frame, it does not copy any pixels. 
+    //! It can be transposed after cropping and a transposed frame can be cropped as well.
+    Frame crop(DimensionsType x, DimensionsType y, DimensionsType width, DimensionsType height) const;
+
     void set(DimensionsType x, DimensionsType y, const Pixel& pixel);
     Pixel get(DimensionsType x, DimensionsType y) const;
 
     DimensionsType getWidth() const;
     DimensionsType getHeight() const;
 
+    bool isTransposed() const { return m_transposition != Transposition::None; }
+
+    //! @brief Provides unchecked access to pixels of a column of the underlying storage, pixels of the column 
+    //! are stored contiguously. Transposition is ignored, so column x is the same as of the non transposed frame.
+    //! @note meant only for performance critical loops, which are responsible for staying within the bounds.
+    const Pixel* getColumnData(DimensionsType x) const { return (*m_pixels)[m_offset_x + x].data() + m_offset_y; }
+
 private:
     enum class Transposition
     {
@@ -49,5 +66,10 @@ private:
     std::shared_ptr<PixelContainer> m_pixels;
     // ownership semantics imply only content ownership, not the allocated memory ownership
     bool m_owns_content;
-    const Transposition m_transposition = Transposition::None;
+    Transposition m_transposition = Transposition::None;
+    // region of the underlying storage which is covered by the frame
+    DimensionsType m_offset_x = 0;
+    DimensionsType m_offset_y = 0;
+    DimensionsType m_width = 0;
+    DimensionsType m_height = 0;
 };
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include <algorithm>
+
+#include "frameproviderinterface.h"
+#include "frame.h"
+
+namespace
+{
+    constexpr uint32_t SKIPPED_FRAMES_BATCH_SIZE = 8;
+}
+
+std::optional<Frame> FrameProviderInterface::getNext()
+{
+    std::vector<Frame> frames;
+
+    if (fill(frames, 1) == 0)
+    {
+        return {};
+    }
+
+    return frames.front();
+}
+
+bool FrameProviderInterface::skip(uint32_t frame_count)
+{
+    // skipped frames are acquired in batches into the same storage, so that memory is not reallocated
+    std::vector<Frame> frames;
+
+    while (frame_count > 0)
+    {
+        const auto acquired_frames = fill(frames, std::min(frame_count, SKIPPED_FRAMES_BATCH_SIZE));
+        if (acquired_frames == 0)
+        {
+            return false;
+        }
+
+        frame_count -= static_cast<uint32_t>(acquired_frames);
+    }
+
+    return true;
+}
+
+Frame& FrameProviderInterface::prepareFrame(std::vector<Frame>& frames, std::size_t index,
+    common::DimensionsType width, common::DimensionsType height)
+{
+    if (index < frames.size())
+    {
+        frames[index].reuse(width, height);
+        return frames[index];
+    }
+
+    return frames.emplace_back(width, height);
+}
+
+void FrameProviderInterface::storeFrame(std::vector<Frame>& frames, std::size_t index, const Frame& frame)
+{
+    if (index < frames.size())
+    {
+        frames[index] = frame;
+    }
+    else
+    {
+        frames.push_back(frame);
+    }
+}
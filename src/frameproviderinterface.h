@@ -1,7 +1,11 @@
-
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <vector>
+
+#include "commondefinitions.h"
 
 class Frame;
 
@@ -12,5 +16,26 @@ public:
     virtual ~FrameProviderInterface() = default;
 
     virtual bool isReady() const = 0;
-    virtual std::optional<Frame> getNext() = 0;
+
+    //! @brief Acquires up to max_frames next frames at once. Frames already present in the container are used
+    //! as a storage for the acquired ones whenever possible, so that their memory doesn't have to be reallocated.
+    //! @note container is never shrunk, elements past the returned amount shall be considered as a spare storage.
+    //! @return amount of acquired frames, 0 means that all of the frames were provided.
+    virtual std::size_t fill(std::vector<Frame>& frames, std::size_t max_frames) = 0;
+
+    //! @brief Acquires a single frame, it's an adapter of fill() kept for compatibility.
+    virtual std::optional<Frame> getNext();
+
+    //! @brief Skips next frame_count frames, by default they are acquired and dropped, providers which are able to
+    //! seek shall override it.
+    //! @return false when there were less frames available than requested.
+    virtual bool skip(uint32_t frame_count);
+
+protected:
+    //! @brief Provides frame of the container at given index prepared to be overwritten, appends it if necessary.
+    static Frame& prepareFrame(std::vector<Frame>& frames, std::size_t index,
+        common::DimensionsType width, common::DimensionsType height);
+
+    //! @brief Stores (shares) already created frame at given index of the container, appends it if necessary.
+    static void storeFrame(std::vector<Frame>& frames, std::size_t index, const Frame& frame);
 };
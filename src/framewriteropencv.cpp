@@ -0,0 +1,64 @@
+#include <opencv2/opencv.hpp>
+#include <spdlog/spdlog.h>
+
+#include "framewriteropencv.h"
+#include "frame.h"
+
+FrameWriterOpenCv::FrameWriterOpenCv(const std::string& file_path, bool is_video, double fps) :
+    m_file_path(file_path),
+    m_is_video(is_video),
+    m_fps(fps)
+{
+    static_assert(sizeof(cv::Vec3b::value_type) == sizeof(Pixel::Color));
+}
+
+bool FrameWriterOpenCv::write(const Frame& frame)
+{
+    if (m_written && !m_is_video)
+    {
+        spdlog::warn("image has been already written, ignoring subsequent frames");
+        return true;
+    }
+
+    const auto cols = frame.getWidth();
+    const auto rows = frame.getHeight();
+
+    // pixels are stored in the same channel order as they are read by frame providers
+    cv::Mat mat(rows, cols, CV_8UC3);
+    for (Frame::DimensionsType row = 0; row < rows; row++)
+    {
+        for (Frame::DimensionsType col = 0; col < cols; col++)
+        {
+            const auto& src_pixel = frame.get(col, row);
+
+            auto& dst_pixel = mat.at<cv::Vec3b>(row, col);
+            dst_pixel[0] = src_pixel.m_red;
+            dst_pixel[1] = src_pixel.m_green;
+            dst_pixel[2] = src_pixel.m_blue;
+        }
+    }
+
+    if (!m_is_video)
+    {
+        m_written = cv::imwrite(m_file_path, mat);
+        if (!m_written)
+        {
+            spdlog::error("failed to write image {}", m_file_path);
+        }
+        return m_written;
+    }
+
+    if (!m_written)
+    {
+        m_video_writer.open(m_file_path, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), m_fps, cv::Size(cols, rows));
+        if (!m_video_writer.isOpened())
+        {
+            spdlog::error("failed to open video {} for writing", m_file_path);
+            return false;
+        }
+        m_written = true;
+    }
+
+    m_video_writer.write(mat);
+    return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+#include <opencv2/videoio.hpp>
+
+class Frame;
+
+/**
+ * @brief Writes frames either into a video file or into a single image file.
+ */
+class FrameWriterOpenCv
+{
+public:
+    FrameWriterOpenCv(const std::string& file_path, bool is_video, double fps = 25.);
+    ~FrameWriterOpenCv() = default;
+
+    //! @note in case of an image only the first frame is written, the rest of them are ignored.
+    bool write(const Frame& frame);
+
+private:
+    const std::string m_file_path;
+    const bool m_is_video;
+    const double m_fps;
+    cv::VideoWriter m_video_writer;
+    bool m_written = false;
+};
@@ -4,6 +4,15 @@
 #include "imageframeprovideropencv.h"
 #include "frame.h"
 
+namespace
+{
+    // files which are not readable are skipped both when frames are filled and skipped, so that frame indices match
+    bool isReadable(const FilePrefetcher::FileBuffer& buffer)
+    {
+        return buffer.m_is_read && !buffer.m_data.empty();
+    }
+}
+
 ImageFrameProviderOpenCv::ImageFrameProviderOpenCv(const std::string& file_path): 
     FrameProviderInterface(), 
     m_image(cv::imread(file_path))
@@ -11,45 +20,136 @@ ImageFrameProviderOpenCv::ImageFrameProviderOpenCv(const std::string& file_path)
     static_assert(sizeof(cv::Vec3b::value_type) == sizeof(Pixel::Color));
 }
 
+ImageFrameProviderOpenCv::ImageFrameProviderOpenCv(std::vector<std::string> file_paths, std::size_t read_ahead): 
+    FrameProviderInterface(), 
+    m_prefetcher(std::make_unique<FilePrefetcher>(std::move(file_paths), read_ahead))
+{
+    // the first image is decoded upfront, so that readiness reflects whether there is anything to provide
+    m_consumed = !decodeNext();
+}
+
 bool ImageFrameProviderOpenCv::isReady() const 
 {
     return m_image.cols > 0 && m_image.rows > 0;
 }
 
-std::optional<Frame> ImageFrameProviderOpenCv::getNext() 
+std::size_t ImageFrameProviderOpenCv::fill(std::vector<Frame>& frames, std::size_t max_frames) 
 {
     if (!isReady())
     {
         spdlog::warn("image read is not ready");
-        return {};
+        return 0;
+    }
+
+    std::size_t filled_frames = 0;
+    for (; filled_frames < max_frames; filled_frames++)
+    {
+        if (m_consumed && !decodeNext())
+        {
+            break;
+        }
+
+        const auto cols = static_cast<Frame::DimensionsType>(m_image.cols);
+        const auto rows = static_cast<Frame::DimensionsType>(m_image.rows);
+
+        auto& frame = prepareFrame(frames, filled_frames, cols, rows);
+        for (Frame::DimensionsType row = 0; row < rows; row++) 
+        {
+            for (Frame::DimensionsType col = 0; col < cols; col++)
+            {
+                const auto& src_pixel = m_image.at<cv::Vec3b>(row, col);
+
+                Pixel dst_pixel;
+                dst_pixel.m_red = src_pixel[0];
+                dst_pixel.m_green = src_pixel[1];
+                dst_pixel.m_blue = src_pixel[2];
+
+                frame.set(col, row, dst_pixel);
+            }
+        }
+
+        m_consumed = true;
     }
 
-    if (m_consumed)
+    if (filled_frames == 0)
     {
-        spdlog::warn("image's frame has been already consumed");
-        return {};
+        spdlog::info("image's frame has been already consumed");
     }
 
-    const auto cols = static_cast<Frame::DimensionsType>(m_image.cols);
-    const auto rows = static_cast<Frame::DimensionsType>(m_image.rows);
+    return filled_frames;
+}
 
-    Frame frame(cols, rows);
-    for (Frame::DimensionsType row = 0; row < rows; row++) 
+bool ImageFrameProviderOpenCv::skip(uint32_t frame_count)
+{
+    for (uint32_t i = 0; i < frame_count; i++)
     {
-        for (Frame::DimensionsType col = 0; col < cols; col++)
+        if (!m_consumed)
         {
-            const auto& src_pixel = m_image.at<cv::Vec3b>(row, col);
+            m_consumed = true;
+            continue;
+        }
 
-            Pixel dst_pixel;
-            dst_pixel.m_red = src_pixel[0];
-            dst_pixel.m_green = src_pixel[1];
-            dst_pixel.m_blue = src_pixel[2];
+        if (!m_prefetcher)
+        {
+            return false;
+        }
 
-            frame.set(col, row, dst_pixel);
+        const auto* buffer = m_prefetcher->next();
+        while (buffer && !isReadable(*buffer))
+        {
+            spdlog::error("image {} cannot be read, it's skipped", buffer->m_path);
+            buffer = m_prefetcher->next();
+        }
+
+        if (!buffer)
+        {
+            return false;
         }
     }
 
-    m_consumed = true;
+    return true;
+}
+
+bool ImageFrameProviderOpenCv::decodeNext()
+{
+    if (!m_prefetcher)
+    {
+        return false;
+    }
+
+    while (const auto* buffer = m_prefetcher->next())
+    {
+        if (!isReadable(*buffer))
+        {
+            spdlog::error("image {} cannot be read, it's skipped", buffer->m_path);
+            continue;
+        }
+
+        // decoded image reuses memory of the previous one when their sizes match
+        cv::imdecode(buffer->m_data, cv::IMREAD_COLOR, &m_image);
+
+        if (m_image.empty())
+        {
+            spdlog::error("image {} cannot be decoded, it's skipped", buffer->m_path);
+            continue;
+        }
+
+        // frames of a single input have to be of the same dimensions, the first image determines them
+        if (m_image_size.empty())
+        {
+            m_image_size = m_image.size();
+        }
+
+        if (m_image.size() != m_image_size)
+        {
+            spdlog::error("image {} is {}x{} unlike {}x{} of the first image, it's skipped", buffer->m_path,
+                m_image.cols, m_image.rows, m_image_size.width, m_image_size.height);
+            continue;
+        }
+
+        m_consumed = false;
+        return true;
+    }
 
-    return frame;
+    return false;
 }
@@ -1,20 +1,39 @@
-
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <opencv2/core/mat.hpp>
 
+#include "fileprefetcher.h"
 #include "frameproviderinterface.h"
 
 class ImageFrameProviderOpenCv: public FrameProviderInterface
 {
 public:
     ImageFrameProviderOpenCv(const std::string& file_path);
+
+    //! @brief Provides each of the images as a single frame, upcoming files are read ahead and decoded from memory.
+    //! @note images which cannot be decoded or whose dimensions differ from the first decoded image are skipped.
+    ImageFrameProviderOpenCv(std::vector<std::string> file_paths, std::size_t read_ahead);
     ~ImageFrameProviderOpenCv() = default;
 
     bool isReady() const override;
-    std::optional<Frame> getNext() override;
+    std::size_t fill(std::vector<Frame>& frames, std::size_t max_frames) override;
+
+    //! @brief Skipped files are read, but not decoded. Files which cannot be read are passed over as when frames
+    //! are filled, but readable files which turn out not to be decodable or of different dimensions are counted
+    //! as skipped frames.
+    bool skip(uint32_t frame_count) override;
 
 private:
-    const cv::Mat m_image;
+    bool decodeNext();
+
+    std::unique_ptr<FilePrefetcher> m_prefetcher;
+    // decoded image is kept between reads, so that its memory can be reused
+    cv::Mat m_image;
+    // dimensions of the first decoded image, which the following images have to match
+    cv::Size m_image_size;
     bool m_consumed = false;
 };
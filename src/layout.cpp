@@ -0,0 +1,124 @@
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <spdlog/spdlog.h>
+
+#include "layout.h"
+
+namespace
+{
+    bool isWithinTolerance(int first, int second, int tolerance)
+    {
+        return std::abs(first - second) <= tolerance;
+    }
+
+    bool isMatching(const MosaicDecomposer::SplitDimensions& detected, const MosaicDecomposer::SplitDimensions& expected,
+        int tolerance)
+    {
+        return isWithinTolerance(detected.m_x, expected.m_x, tolerance) &&
+            isWithinTolerance(detected.m_y, expected.m_y, tolerance) &&
+            isWithinTolerance(detected.m_x + detected.m_width, expected.m_x + expected.m_width, tolerance) &&
+            isWithinTolerance(detected.m_y + detected.m_height, expected.m_y + expected.m_height, tolerance);
+    }
+}
+
+std::optional<layout::Layout> layout::load(const std::string& file_path)
+{
+    std::ifstream stream(file_path);
+    if (!stream)
+    {
+        spdlog::error("failed to open layout file {}", file_path);
+        return {};
+    }
+
+    Layout loaded;
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        std::istringstream line_stream(line);
+        unsigned x = 0;
+        unsigned y = 0;
+        unsigned width = 0;
+        unsigned height = 0;
+
+        if (!(line_stream >> x >> y >> width >> height))
+        {
+            spdlog::error("malformed line in layout file {}: {}", file_path, line);
+            return {};
+        }
+
+        loaded.push_back(MosaicDecomposer::SplitDimensions{static_cast<MosaicDecomposer::SplitPosition>(x),
+            static_cast<MosaicDecomposer::SplitPosition>(y),
+            static_cast<common::DimensionsType>(width),
+            static_cast<common::DimensionsType>(height)});
+    }
+
+    return loaded;
+}
+
+bool layout::save(const std::string& file_path, const Layout& layout)
+{
+    std::ofstream stream(file_path, std::ios::trunc);
+    if (!stream)
+    {
+        spdlog::error("failed to open layout file {} for writing", file_path);
+        return false;
+    }
+
+    stream << "# x y width height\n";
+    for (const auto& data : layout)
+    {
+        stream << data.m_x << ' ' << data.m_y << ' ' << data.m_width << ' ' << data.m_height << '\n';
+    }
+
+    return static_cast<bool>(stream);
+}
+
+double layout::score(const Layout& detected, const Layout& expected, common::DimensionsType tolerance)
+{
+    if (detected.empty() && expected.empty())
+    {
+        return 1.;
+    }
+
+    std::vector<bool> used(detected.size(), false);
+    std::size_t matched = 0;
+
+    for (const auto& expected_mosaic : expected)
+    {
+        for (std::size_t i = 0; i < detected.size(); i++)
+        {
+            if (!used[i] && isMatching(detected[i], expected_mosaic, tolerance))
+            {
+                used[i] = true;
+                matched++;
+                break;
+            }
+        }
+    }
+
+    return 2. * static_cast<double>(matched) / static_cast<double>(detected.size() + expected.size());
+}
+
+std::string layout::toString(const Layout& layout)
+{
+    std::ostringstream stream;
+
+    for (const auto& data : layout)
+    {
+        if (stream.tellp() > 0)
+        {
+            stream << ' ';
+        }
+
+        stream << '(' << data.m_x << ';' << data.m_y << ")," << data.m_width << 'x' << data.m_height;
+    }
+
+    return stream.str();
+}
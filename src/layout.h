@@ -0,0 +1,27 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mosaicdecomposer.h"
+
+/*!
+ * @brief Helpers for comparing calculated mosaic dimensions against known (ground truth) layouts.
+ */
+namespace layout
+{
+    using Layout = std::vector<MosaicDecomposer::SplitDimensions>;
+
+    //! @brief Loads layout from a text file, each line contains "x y width height" of a single mosaic.
+    std::optional<Layout> load(const std::string& file_path);
+
+    bool save(const std::string& file_path, const Layout& layout);
+
+    //! @brief Calculates F1 score of the detected layout, where mosaic is considered as correctly detected
+    //! when all of its borders are within given tolerance of the expected mosaic borders.
+    //! @return value in range [0, 1], where 1 means that layouts are equal.
+    double score(const Layout& detected, const Layout& expected, common::DimensionsType tolerance = 2);
+
+    std::string toString(const Layout& layout);
+}
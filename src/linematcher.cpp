@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "linematcher.h"
+
+// color match diffs for which the counters are instantiated at compile time, can be overridden by the build
+#ifndef SPECIALIZED_COLOR_MATCH_DIFFS
+#define SPECIALIZED_COLOR_MATCH_DIFFS 40, 60, 80, 100, 120
+#endif
+
+namespace
+{
+    using linematcher::Orientation;
+    using linematcher::MatchCounter;
+
+    using SpecializedDeviations = std::integer_sequence<uint16_t, SPECIALIZED_COLOR_MATCH_DIFFS>;
+
+    template <Orientation LineOrientation, uint16_t AcceptableColorDeviation>
+    common::DimensionsType countWithFixedDeviation(const Frame& frame, common::DimensionsType line,
+        common::DimensionsType begin, common::DimensionsType end, uint16_t)
+    {
+        return linematcher::countMatchedPixels<LineOrientation>(frame, line, begin, end,
+            linematcher::FixedDeviation<AcceptableColorDeviation>{});
+    }
+
+    template <Orientation LineOrientation>
+    common::DimensionsType countWithRuntimeDeviation(const Frame& frame, common::DimensionsType line,
+        common::DimensionsType begin, common::DimensionsType end, uint16_t acceptable_color_deviation)
+    {
+        return linematcher::countMatchedPixels<LineOrientation>(frame, line, begin, end,
+            linematcher::RuntimeDeviation{acceptable_color_deviation});
+    }
+
+    // amount of subsequent frames with most lines changed after which the comparison is done only occasionally
+    constexpr uint32_t CHANGED_FRAMES_BEFORE_BACKOFF = 4;
+    // amount of frames whose lines are reported as unknown between the occasional comparisons
+    constexpr uint32_t BACKOFF_FRAMES = 15;
+
+    // columns are compared bytewise, hence pixels must not contain any padding
+    static_assert(std::has_unique_object_representations_v<Pixel>);
+
+    template <Orientation LineOrientation, uint16_t... Deviations>
+    MatchCounter findSpecialization(uint16_t acceptable_color_deviation, std::integer_sequence<uint16_t, Deviations...>)
+    {
+        MatchCounter counter = nullptr;
+
+        ((acceptable_color_deviation == Deviations ?
+            (counter = &countWithFixedDeviation<LineOrientation, Deviations>, true) : false) || ...);
+
+        return counter;
+    }
+}
+
+linematcher::MatchCounter linematcher::selectMatchCounter(Orientation orientation, uint16_t acceptable_color_deviation)
+{
+    if (orientation == Orientation::Horizontal)
+    {
+        const auto counter = findSpecialization<Orientation::Horizontal>(acceptable_color_deviation, SpecializedDeviations{});
+        return counter ? counter : &countWithRuntimeDeviation<Orientation::Horizontal>;
+    }
+
+    const auto counter = findSpecialization<Orientation::Vertical>(acceptable_color_deviation, SpecializedDeviations{});
+    return counter ? counter : &countWithRuntimeDeviation<Orientation::Vertical>;
+}
+
+bool linematcher::isSpecialized(uint16_t acceptable_color_deviation)
+{
+    return findSpecialization<Orientation::Horizontal>(acceptable_color_deviation, SpecializedDeviations{}) != nullptr;
+}
+
+void linematcher::ChangeDetector::detect(const Frame& frame, ChangedLines& changes)
+{
+    const auto width = frame.getWidth();
+    const auto height = frame.getHeight();
+
+    const auto previous_frame = std::move(m_previous_frame);
+    m_previous_frame = frame;
+    changes.m_is_known = false;
+
+    if (!previous_frame || previous_frame->getWidth() != width || previous_frame->getHeight() != height ||
+        frame.isTransposed() || previous_frame->isTransposed())
+    {
+        return;
+    }
+
+    if (m_frames_until_check > 0)
+    {
+        m_frames_until_check--;
+        return;
+    }
+
+    changes.m_rows.assign(height, 0);
+    changes.m_columns.assign(width, 0);
+
+    unsigned changed_rows = 0;
+    unsigned changed_columns = 0;
+
+    for (common::DimensionsType x = 0; x < width; x++)
+    {
+        const auto* column = frame.getColumnData(x);
+        const auto* previous_column = previous_frame->getColumnData(x);
+
+        // most columns of mostly static frames are equal, so they are only compared as a whole
+        if (column == previous_column || std::memcmp(column, previous_column, sizeof(Pixel) * height) == 0)
+        {
+            continue;
+        }
+
+        changes.m_columns[x] = 1;
+        changed_columns++;
+
+        for (common::DimensionsType y = 0; y < height; y++)
+        {
+            // channels are compared without branching, as changes of noisy columns are unpredictable
+            const auto is_changed = static_cast<uint8_t>((column[y].m_red != previous_column[y].m_red) |
+                (column[y].m_green != previous_column[y].m_green) | (column[y].m_blue != previous_column[y].m_blue));
+
+            changed_rows += is_changed & (changes.m_rows[y] ^ 1u);
+            changes.m_rows[y] |= is_changed;
+        }
+
+        // hardly any count could be reused, so the rest of the frame is not compared
+        if (changed_columns * 2 > width && changed_rows * 2 > height)
+        {
+            if (++m_changed_frames >= CHANGED_FRAMES_BEFORE_BACKOFF)
+            {
+                m_frames_until_check = BACKOFF_FRAMES;
+            }
+            return;
+        }
+    }
+
+    m_changed_frames = 0;
+    changes.m_is_known = true;
+}
+
+linematcher::LineMatcher::LineMatcher(Orientation orientation, uint16_t acceptable_color_deviation) :
+    m_orientation(orientation),
+    m_match_counter(selectMatchCounter(orientation, acceptable_color_deviation)),
+    m_acceptable_color_deviation(acceptable_color_deviation)
+{
+}
+
+const std::vector<common::DimensionsType>& linematcher::LineMatcher::countMatchedPixels(const Frame& frame,
+    common::DimensionsType first_line, common::DimensionsType end_line, const ChangedLines* changes)
+{
+    const auto line_count = m_orientation == Orientation::Horizontal ? frame.getHeight() : frame.getWidth();
+    const auto line_width = m_orientation == Orientation::Horizontal ? frame.getWidth() : frame.getHeight();
+
+    // cached counts are valid only for the same range of lines of the same dimensions
+    const auto is_cache_valid = changes && changes->m_is_known && m_matched_pixels.size() == line_count && 
+        m_first_line == first_line && m_end_line == end_line;
+
+    m_matched_pixels.resize(line_count);
+    m_first_line = first_line;
+    m_end_line = end_line;
+
+    const uint8_t* changed_lines = nullptr;
+    if (is_cache_valid)
+    {
+        changed_lines = m_orientation == Orientation::Horizontal ? changes->m_rows.data() : changes->m_columns.data();
+    }
+
+    for (auto line = first_line; line < end_line; line++)
+    {
+        if (changed_lines && !changed_lines[line] && !changed_lines[line + 1u])
+        {
+            m_reused_lines++;
+            continue;
+        }
+
+        m_matched_pixels[line] = m_match_counter(frame, line, 0, line_width, m_acceptable_color_deviation);
+        m_counted_lines++;
+    }
+
+    return m_matched_pixels;
+}
+
+linematcher::Orientation linematcher::LineMatcher::getOrientation() const
+{
+    return m_orientation;
+}
+
+common::DimensionsType linematcher::LineMatcher::countMatchedPixels(const Frame& frame, common::DimensionsType line)
+{
+    const auto line_width = m_orientation == Orientation::Horizontal ? frame.getWidth() : frame.getHeight();
+
+    m_counted_lines++;
+    return m_match_counter(frame, line, 0, line_width, m_acceptable_color_deviation);
+}
+
+common::DimensionsType linematcher::LineMatcher::estimateMatchedPixels(const Frame& frame, common::DimensionsType line, 
+    common::DimensionsType block_size, const SampleAvgStorage& average, SampleAvgStorage::Ratio ratio)
+{
+    const auto line_width = m_orientation == Orientation::Horizontal ? frame.getWidth() : frame.getHeight();
+
+    common::DimensionsType matched_pixels = 0;
+    for (common::DimensionsType begin = 0; begin < line_width; )
+    {
+        const auto end = static_cast<common::DimensionsType>(std::min(begin + block_size, int{line_width}));
+        matched_pixels = static_cast<common::DimensionsType>(matched_pixels + 
+            m_match_counter(frame, line, begin, end, m_acceptable_color_deviation));
+
+        const auto remaining_pixels = static_cast<common::DimensionsType>(line_width - end);
+        if (remaining_pixels == 0)
+        {
+            break;
+        }
+
+        // line is not below average even if none of the remaining pixels matches, or it is even if all of them match
+        const auto is_settled = !average.isBelowAverage(matched_pixels, line_width, ratio) ||
+            average.isBelowAverage(static_cast<common::DimensionsType>(matched_pixels + remaining_pixels), line_width, ratio);
+
+        if (is_settled)
+        {
+            m_estimated_lines++;
+            return static_cast<common::DimensionsType>(matched_pixels + uint32_t{remaining_pixels} * matched_pixels / end);
+        }
+
+        begin = end;
+    }
+
+    m_counted_lines++;
+    return matched_pixels;
+}
+
+common::DimensionsType linematcher::LineMatcher::countSampledPixels(const Frame& frame, common::DimensionsType line, 
+    common::DimensionsType stride) const
+{
+    const RuntimeDeviation compare{m_acceptable_color_deviation};
+    unsigned matched_pixels = 0;
+
+    if (m_orientation == Orientation::Horizontal)
+    {
+        // sampled columns are contiguous, so both lines are read from the same cache lines
+        for (unsigned x = 0; x < frame.getWidth(); x += stride)
+        {
+            const auto* column = frame.getColumnData(static_cast<common::DimensionsType>(x));
+            matched_pixels += compare(column[line], column[line + 1]);
+        }
+    }
+    else
+    {
+        const auto* current_column = frame.getColumnData(line);
+        const auto* next_column = frame.getColumnData(static_cast<common::DimensionsType>(line + 1));
+
+        for (unsigned y = 0; y < frame.getHeight(); y += stride)
+        {
+            matched_pixels += compare(current_column[y], next_column[y]);
+        }
+    }
+
+    return static_cast<common::DimensionsType>(matched_pixels);
+}
+
+uint64_t linematcher::LineMatcher::getCountedLines() const
+{
+    return m_counted_lines;
+}
+
+uint64_t linematcher::LineMatcher::getReusedLines() const
+{
+    return m_reused_lines;
+}
+
+uint64_t linematcher::LineMatcher::getEstimatedLines() const
+{
+    return m_estimated_lines;
+}
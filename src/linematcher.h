@@ -0,0 +1,161 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+#include <cstdint>
+
+#include "analysisstate.h"
+#include "commondefinitions.h"
+#include "frame.h"
+
+/*!
+ * @brief Kernels which count matching pixels of adjacent lines, they access the frame's storage directly,
+ * so that the compiler is able to unroll and vectorize them.
+ */
+namespace linematcher
+{
+    enum class Orientation
+    {
+        // lines are rows of the frame, each row is matched with the next one
+        Horizontal,
+        // lines are columns of the frame, each column is matched with the next one
+        Vertical
+    };
+
+    template <uint16_t AcceptableColorDeviation>
+    struct FixedDeviation
+    {
+        constexpr bool operator()(const Pixel& first, const Pixel& second) const
+        {
+            return first.coarseCompare<AcceptableColorDeviation>(second);
+        }
+    };
+
+    struct RuntimeDeviation
+    {
+        bool operator()(const Pixel& first, const Pixel& second) const
+        {
+            return first.colorDifference(second) <= m_acceptable_color_deviation;
+        }
+
+        uint16_t m_acceptable_color_deviation;
+    };
+
+    //! @brief Counts pixels of the line in range [begin, end) which match with the adjacent pixels of the next line.
+    //! @note frame must not be transposed, vertical orientation is used instead.
+    template <Orientation LineOrientation, class Comparator>
+    common::DimensionsType countMatchedPixels(const Frame& frame, common::DimensionsType line, 
+        common::DimensionsType begin, common::DimensionsType end, Comparator compare)
+    {
+        unsigned matched_pixels = 0;
+
+        if constexpr (LineOrientation == Orientation::Horizontal)
+        {
+            for (auto x = begin; x < end; x++)
+            {
+                const auto* column = frame.getColumnData(x);
+                matched_pixels += compare(column[line], column[line + 1]);
+            }
+        }
+        else
+        {
+            // pixels of a column are contiguous, hence this loop is vectorized
+            const auto* current_column = frame.getColumnData(line);
+            const auto* next_column = frame.getColumnData(static_cast<common::DimensionsType>(line + 1));
+
+            for (auto y = begin; y < end; y++)
+            {
+                matched_pixels += compare(current_column[y], next_column[y]);
+            }
+        }
+
+        return static_cast<common::DimensionsType>(matched_pixels);
+    }
+
+    using MatchCounter = common::DimensionsType (*)(const Frame& frame, common::DimensionsType line,
+        common::DimensionsType begin, common::DimensionsType end, uint16_t acceptable_color_deviation);
+
+    //! @brief Selects counter which was instantiated for given deviation at compile time (see
+    //! SPECIALIZED_COLOR_MATCH_DIFFS), falls back to the one which compares with deviation at runtime otherwise.
+    MatchCounter selectMatchCounter(Orientation orientation, uint16_t acceptable_color_deviation);
+
+    bool isSpecialized(uint16_t acceptable_color_deviation);
+
+    //! @brief Rows and columns of a frame which differ from the previous frame, flags are indexed by the line.
+    struct ChangedLines
+    {
+        //! @brief Whether the flags were determined, all lines have to be considered as changed otherwise.
+        bool m_is_known = false;
+        std::vector<uint8_t> m_rows;
+        std::vector<uint8_t> m_columns;
+    };
+
+    /*!
+     * @brief Finds lines which changed since the previous frame by comparing pixels of both frames exactly,
+     * rows and columns are determined in a single pass over the contiguous columns. Flags are meant to be shared
+     * by matchers of both orientations.
+     * @note once most lines keep changing (e.g. noisy input) the comparison does not pay off, hence it's done only
+     * for every few frames then, lines of the rest are reported as unknown.
+     */
+    class ChangeDetector
+    {
+    public:
+        //! @brief Compares frame with the previous one, the frame is kept as the previous one afterwards.
+        void detect(const Frame& frame, ChangedLines& changes);
+
+    private:
+        // frame is shared, hence its memory is not reused by the provider while it's kept
+        std::optional<Frame> m_previous_frame;
+        uint32_t m_changed_frames = 0;
+        uint32_t m_frames_until_check = 0;
+    };
+
+    /*!
+     * @brief Counts matched pixels of all lines of subsequent frames in a single orientation.
+     * When changed lines of the frame are given, only lines which changed (or whose next line changed) since
+     * the previous frame are counted again, counts of the rest are reused.
+     */
+    class LineMatcher
+    {
+    public:
+        LineMatcher(Orientation orientation, uint16_t acceptable_color_deviation);
+
+        //! @brief Counts matched pixels of lines in range [first_line, end_line) with their next lines,
+        //! counts are indexed by the line.
+        //! @param changes lines changed since the frame counted by the previous call, nullptr to count all lines.
+        const std::vector<common::DimensionsType>& countMatchedPixels(const Frame& frame, 
+            common::DimensionsType first_line, common::DimensionsType end_line, const ChangedLines* changes = nullptr);
+
+        //! @brief Counts matched pixels of a single line with its next line, cached counts are not used.
+        common::DimensionsType countMatchedPixels(const Frame& frame, common::DimensionsType line);
+
+        //! @brief Counts matched pixels of the line in blocks and stops as soon as it's settled whether the line's
+        //! match rate is below average / ratio. The count of the rest of the line is extrapolated out of the counted
+        //! part then, the estimate is bounded, so that the line is classified the same as by the exact count.
+        common::DimensionsType estimateMatchedPixels(const Frame& frame, common::DimensionsType line, 
+            common::DimensionsType block_size, const SampleAvgStorage& average, SampleAvgStorage::Ratio ratio);
+
+        //! @brief Counts matched pixels of every stride-th pixel of the line, i.e. cheap estimate of the line's match.
+        common::DimensionsType countSampledPixels(const Frame& frame, common::DimensionsType line, 
+            common::DimensionsType stride) const;
+
+        Orientation getOrientation() const;
+        uint64_t getCountedLines() const;
+        uint64_t getReusedLines() const;
+        uint64_t getEstimatedLines() const;
+
+    private:
+        const Orientation m_orientation;
+        const MatchCounter m_match_counter;
+        const uint16_t m_acceptable_color_deviation;
+
+        std::vector<common::DimensionsType> m_matched_pixels;
+        // range of lines whose counts are valid
+        common::DimensionsType m_first_line = 0;
+        common::DimensionsType m_end_line = 0;
+
+        uint64_t m_counted_lines = 0;
+        uint64_t m_reused_lines = 0;
+        uint64_t m_estimated_lines = 0;
+    };
+}
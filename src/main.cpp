@@ -1,6 +1,10 @@
 #include <memory>
 #include <string>
 #include <limits>
+#include <cstdlib>
+#include <algorithm>
+#include <optional>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 #include <docopt/docopt.h>
@@ -8,6 +12,23 @@
 #include "videoframeprovideropencv.h"
 #include "imageframeprovideropencv.h"
 #include "mosaicdecomposer.h"
+#include "framewriteropencv.h"
+#include "layout.h"
+#include "parametersweep.h"
+#include "syntheticmosaicgenerator.h"
+#include "threadpool.h"
+#include "topology.h"
+
+#ifdef USE_LIBAV
+#include "videoframeproviderlibav.h"
+#endif
+
+#ifdef USE_SERVER
+#include <csignal>
+#include <pthread.h>
+
+#include "decompositionserver.h"
+#endif
 
 static constexpr auto VERSION = "0.1";
 
@@ -16,21 +37,58 @@ static constexpr auto USAGE =
 R"(Mosaic decomposer.
 
     Usage:
-      decompose (video | image) <file-path> [--frames=<frames>] [--skip-front-lines=<front>] [--skip-back-lines=<back>] [--pixel-match=<pm>] [--color-match=<diff>] [--line-match=<lm>]
+      decompose (video | image) <file-path> [<next-file-path>...] [--frames=<frames>] [--start-frame=<start>] [--end-frame=<end>] [--skip-front-lines=<front>] [--skip-back-lines=<back>] [--pixel-match=<pm>] [--color-match=<diff>] [--line-match=<lm>] [--skip-duplicates=<diff>] [--incremental] [--coarse-stride=<stride>] [--refine-radius=<radius>] [--early-exit=<block>] [--recursion=<depth>] [--recursion-frames=<frames>] [--recursion-size=<size>] [--keyframes-only] [--time-budget=<ms>] [--read-ahead=<files>] [--export=<state-file>] [--threads=<threads>] [--affinity=<mode>]
+      decompose retune <state-file> [--line-match=<lm>]
+      decompose merge <partial-file>... [--line-match=<lm>] [--export=<state-file>]
+      decompose sweep (video | image) <file-path> [--frames=<frames>] [--start-frame=<start>] [--end-frame=<end>] [--skip-front-lines=<front>] [--skip-back-lines=<back>] [--pixel-match=<pm>] [--color-match=<diff>] [--line-match=<lm>] [--skip-duplicates=<diff>] [--keyframes-only] [--ground-truth=<layout-file>] [--threads=<threads>] [--affinity=<mode>]
+      decompose generate (video | image) <file-path> [--grid=<grid>] [--size=<size>] [--frames=<frames>] [--noise=<noise>] [--compression=<strength>] [--jitter=<jitter>] [--blend-borders] [--seed=<seed>]
+      decompose serve <socket-path> [--workers=<workers>] [--queue=<jobs>] [--timeout=<ms>] [--affinity=<mode>]
       decompose (-h | --help)
       decompose --version
 
     Options:
       -h --help                   Show this screen.
       video                       Specifies video decomposition mode. file path must be a valid video file.
-      image                       Specifies image decomposition mode. file path must be a valid image file.
+      image                       Specifies image decomposition mode. file path must be a valid image file, each of the next files is another frame.
+      retune                      Calculates dimensions out of previously exported analysis state without decoding the input again.
+      merge                       Calculates dimensions out of merged analysis states exported for time ranges of a single input.
+      sweep                       Evaluates all combinations of comma separated values of pixel, color and line match parameters.
+      generate                    Generates synthetic mosaics with a known layout, the layout is written into <file-path>.layout.
+      serve                       Runs as a daemon which decomposes inputs requested over a Unix socket, until SIGINT or SIGTERM.
       --version                   Show version.
-      --frames=<frames>           Amount of frames to analyze, 0 for all available [default: 0].
+      --frames=<frames>           Amount of frames to analyze, 0 for all available (generates 100 frames of a video) [default: 0].
+      --start-frame=<start>       Index of the first frame to analyze, preceding frames are skipped [default: 0].
+      --end-frame=<end>           Index of the frame at which the analysis stops (exclusive), 0 for the end of the input [default: 0].
       --skip-front-lines=<front>  Amount of lines to be skipped from the front [default: 5].
       --skip-back-lines=<back>    Amount of lines to be skipped from the back [default: 5].
       --pixel-match=<pm>          Ratio used to decide whether a line shall be considered as a potential split line [default: 1.5].
       --color-match=<diff>        Minimum amount of color units that have to match [default: 80].
       --line-match=<lm>           Ratio used to decide whether a line shall be considered as false positive [default: 1.8].
+      --skip-duplicates=<diff>    Skips frames whose thumbnail differs from the last analyzed one by less color units on average, 0 disables skipping [default: 0].
+      --incremental               Reuses match counts of lines which did not change since the previous frame.
+      --coarse-stride=<stride>    Stride of pixels sampled along lines by the coarse pass, 1 disables the coarse pass [default: 1].
+      --refine-radius=<radius>    Amount of lines around coarse candidates which are matched at full resolution [default: 2].
+      --early-exit=<block>        Stops matching a line once its classification is settled, checked after each block of pixels, 0 disables it [default: 0].
+      --recursion=<depth>         Amount of times split detection is repeated inside of detected mosaics to find nested ones [default: 0].
+      --recursion-frames=<frames>  Amount of analyzed frames retained for the recursion, each of them takes 3 bytes per pixel of memory [default: 16].
+      --recursion-size=<size>     Minimum width and height of a mosaic to be decomposed recursively [default: 32].
+      --keyframes-only            Decodes only keyframes of a video, --frames, --start-frame and --end-frame count keyframes then, requires build with USE_LIBAV enabled.
+      --time-budget=<ms>          Stops decoding after given milliseconds and outputs layout of the frames analyzed so far, 0 disables it [default: 0].
+      --read-ahead=<files>        Amount of image files read ahead of the decoded one, when multiple of them are decomposed [default: 4].
+      --export=<state-file>       Exports intermediate analysis state into a file, so that it can be retuned later.
+      --ground-truth=<layout-file>  File with expected layout used to score swept configurations, each line is "x y width height".
+      --threads=<threads>         Amount of threads used for processing, 0 for all available (of the selected node) [default: 0].
+      --affinity=<mode>           Placement of threads: none, node (the current one), node:<id> or core (each thread on its own cpu of the node) [default: none].
+      --grid=<grid>               Amount of generated mosaic columns and rows [default: 2x2].
+      --size=<size>               Size of generated frames [default: 640x360].
+      --noise=<noise>             Maximum deviation of each color channel caused by generated noise [default: 0].
+      --compression=<strength>    Strength of generated block compression artifacts in range [0, 100] [default: 0].
+      --jitter=<jitter>           Maximum random shift of generated mosaic borders on each frame [default: 0].
+      --blend-borders             Blends generated pixels on borders with the adjacent mosaic.
+      --seed=<seed>               Seed of the generator [default: 0].
+      --workers=<workers>         Amount of jobs served concurrently, 0 for all cpus of the affinity [default: 0].
+      --queue=<jobs>              Amount of jobs waiting for a worker, further jobs are rejected as busy [default: 16].
+      --timeout=<ms>              Timeout in milliseconds of jobs which don't specify one, 0 disables it [default: 0].
 )";
 // clang-format on
 
@@ -38,8 +96,27 @@ struct ParseOptions
 {
     std::string m_file_path;
     bool m_is_video;
+    bool m_is_retune;
+    bool m_is_merge;
+    bool m_is_sweep;
+    bool m_is_generate;
+    bool m_is_serve;
+    bool m_keyframes_only;
+    std::string m_export_path;
+    std::string m_ground_truth_path;
+    std::vector<std::string> m_merge_paths;
+    std::vector<std::string> m_next_file_paths;
+    uint32_t m_read_ahead;
+    uint32_t m_threads;
+    std::string m_affinity;
+    uint32_t m_time_budget;
 
     ConfigParams m_config_params;
+    SweepGrid m_sweep_grid;
+    SyntheticMosaicParams m_synthetic_params;
+    uint32_t m_server_workers;
+    uint32_t m_server_queued_jobs;
+    uint32_t m_server_timeout;
 };
 
 template <class DowncastedType>
@@ -60,28 +137,437 @@ DowncastedType downcastLong(long long value)
     return static_cast<DowncastedType>(value);
 }
 
+template <class ValueType, class Converter>
+std::vector<ValueType> parseList(const std::string& values, Converter converter)
+{
+    std::vector<ValueType> parsed;
+
+    std::string::size_type begin = 0;
+    while (begin <= values.size())
+    {
+        const auto end = std::min(values.find(',', begin), values.size());
+        parsed.push_back(converter(values.substr(begin, end - begin)));
+        begin = end + 1;
+    }
+
+    return parsed;
+}
+
+template <class ValueType>
+ValueType getSingleValue(const std::vector<ValueType>& values, const std::string& option)
+{
+    if (values.size() != 1)
+    {
+        throw std::invalid_argument(option + " accepts multiple values only in sweep mode");
+    }
+
+    return values.front();
+}
+
+std::pair<common::DimensionsType, common::DimensionsType> parseDimensions(const std::string& value)
+{
+    const auto separator = value.find('x');
+    if (separator == std::string::npos)
+    {
+        throw std::invalid_argument("value: " + value + " is not in <width>x<height> format");
+    }
+
+    return {downcastLong<common::DimensionsType>(std::stoll(value.substr(0, separator))),
+        downcastLong<common::DimensionsType>(std::stoll(value.substr(separator + 1)))};
+}
+
+SyntheticMosaicParams parseSyntheticParams(std::map<std::string, docopt::value>& args, bool is_video)
+{
+    const auto [columns, rows] = parseDimensions(args["--grid"].asString());
+    const auto [width, height] = parseDimensions(args["--size"].asString());
+
+    if (columns == 0 || rows == 0 || columns > width || rows > height)
+    {
+        throw std::invalid_argument("grid " + args["--grid"].asString() + " doesn't fit into " + args["--size"].asString());
+    }
+
+    auto params = SyntheticMosaicParams::uniformGrid(width, height, columns, rows);
+
+    params.m_frame_count = downcastLong<decltype(params.m_frame_count)>(args["--frames"].asLong());
+    if (params.m_frame_count == 0)
+    {
+        params.m_frame_count = is_video ? 100 : 1;
+    }
+
+    params.m_noise = downcastLong<decltype(params.m_noise)>(args["--noise"].asLong());
+    params.m_compression = downcastLong<decltype(params.m_compression)>(args["--compression"].asLong());
+    params.m_border_jitter = downcastLong<decltype(params.m_border_jitter)>(args["--jitter"].asLong());
+    params.m_blend_borders = args["--blend-borders"].asBool();
+    params.m_seed = downcastLong<decltype(params.m_seed)>(args["--seed"].asLong());
+
+    return params;
+}
+
 ParseOptions parseArgs(std::map<std::string, docopt::value> args)
 {
     ParseOptions options{};
 
     options.m_is_video = args["video"].asBool();
-    options.m_file_path = args["<file-path>"].asString();
+    options.m_is_retune = args["retune"].asBool();
+    options.m_is_sweep = args["sweep"].asBool();
+    options.m_is_generate = args["generate"].asBool();
+    options.m_is_merge = args["merge"].asBool();
+    options.m_is_serve = args["serve"].asBool();
+    options.m_keyframes_only = args["--keyframes-only"].asBool();
+
+    if (options.m_is_merge)
+    {
+        options.m_merge_paths = args["<partial-file>"].asStringList();
+    }
+    else if (options.m_is_serve)
+    {
+        options.m_file_path = args["<socket-path>"].asString();
+        options.m_server_workers = downcastLong<decltype(options.m_server_workers)>(args["--workers"].asLong());
+        options.m_server_queued_jobs = downcastLong<decltype(options.m_server_queued_jobs)>(args["--queue"].asLong());
+        options.m_server_timeout = downcastLong<decltype(options.m_server_timeout)>(args["--timeout"].asLong());
+    }
+    else
+    {
+        options.m_file_path = options.m_is_retune ? args["<state-file>"].asString() : args["<file-path>"].asString();
+    }
+
+    if (args["<next-file-path>"])
+    {
+        options.m_next_file_paths = args["<next-file-path>"].asStringList();
+    }
+
+    if (args["--export"])
+    {
+        options.m_export_path = args["--export"].asString();
+    }
+
+    if (args["--ground-truth"])
+    {
+        options.m_ground_truth_path = args["--ground-truth"].asString();
+    }
+
+    options.m_threads = downcastLong<decltype(options.m_threads)>(args["--threads"].asLong());
+    options.m_affinity = args["--affinity"].asString();
+
+    const auto is_node_id = options.m_affinity.rfind("node:", 0) == 0 && options.m_affinity.size() > 5 &&
+        options.m_affinity.find_first_not_of("0123456789", 5) == std::string::npos;
+    if (options.m_affinity != "none" && options.m_affinity != "node" && options.m_affinity != "core" && !is_node_id)
+    {
+        throw std::invalid_argument("affinity: " + options.m_affinity + " is not one of none, node, node:<id>, core");
+    }
+    options.m_time_budget = downcastLong<decltype(options.m_time_budget)>(args["--time-budget"].asLong());
+    options.m_read_ahead = downcastLong<decltype(options.m_read_ahead)>(args["--read-ahead"].asLong());
+
+    if (options.m_is_generate)
+    {
+        options.m_synthetic_params = parseSyntheticParams(args, options.m_is_video);
+    }
 
     options.m_config_params.m_frames_to_analyze = 
         downcastLong<decltype(options.m_config_params.m_frames_to_analyze)>(args["--frames"].asLong());
+    options.m_config_params.m_start_frame = 
+        downcastLong<decltype(options.m_config_params.m_start_frame)>(args["--start-frame"].asLong());
+
+    const auto end_frame = downcastLong<uint32_t>(args["--end-frame"].asLong());
+    if (end_frame > 0)
+    {
+        if (end_frame <= options.m_config_params.m_start_frame)
+        {
+            throw std::invalid_argument("end frame: " + std::to_string(end_frame) + " is not past the start frame");
+        }
+
+        // amount of frames, if specified, limits the range even further
+        const auto range_frames = end_frame - options.m_config_params.m_start_frame;
+        auto& frames_to_analyze = options.m_config_params.m_frames_to_analyze;
+        frames_to_analyze = frames_to_analyze == 0 ? range_frames : std::min(frames_to_analyze, range_frames);
+    }
     options.m_config_params.m_skip_front_lines  =
         downcastLong<decltype(options.m_config_params.m_skip_front_lines)>(args["--skip-front-lines"].asLong());
     options.m_config_params.m_skip_back_lines = 
         downcastLong<decltype(options.m_config_params.m_skip_back_lines)>(args["--skip-back-lines"].asLong());
+    options.m_config_params.m_incremental_analysis = args["--incremental"].asBool();
+    options.m_config_params.m_coarse_line_stride = 
+        downcastLong<decltype(options.m_config_params.m_coarse_line_stride)>(args["--coarse-stride"].asLong());
+    options.m_config_params.m_refine_radius = 
+        downcastLong<decltype(options.m_config_params.m_refine_radius)>(args["--refine-radius"].asLong());
+    options.m_config_params.m_early_exit_block = 
+        downcastLong<decltype(options.m_config_params.m_early_exit_block)>(args["--early-exit"].asLong());
+    options.m_config_params.m_recursion_depth = 
+        downcastLong<decltype(options.m_config_params.m_recursion_depth)>(args["--recursion"].asLong());
+    options.m_config_params.m_recursion_frames = 
+        downcastLong<decltype(options.m_config_params.m_recursion_frames)>(args["--recursion-frames"].asLong());
+    options.m_config_params.m_minimum_recursive_size = 
+        downcastLong<decltype(options.m_config_params.m_minimum_recursive_size)>(args["--recursion-size"].asLong());
+    options.m_config_params.m_duplicate_frame_diff = 
+        downcastLong<decltype(options.m_config_params.m_duplicate_frame_diff)>(args["--skip-duplicates"].asLong());
 
-    options.m_config_params.m_minimum_pixel_match_ratio = std::stod(args["--pixel-match"].asString());
-    options.m_config_params.m_minimum_color_match_diff =
-        downcastLong<decltype(options.m_config_params.m_minimum_color_match_diff)>(args["--color-match"].asLong());
-    options.m_config_params.m_minimum_line_match_ratio = std::stod(args["--line-match"].asString());
+    auto& grid = options.m_sweep_grid;
+    const auto& parse_double = [](const std::string& value) { return std::stod(value); };
+
+    grid.m_pixel_match_ratios = parseList<double>(args["--pixel-match"].asString(), parse_double);
+    grid.m_color_match_diffs = parseList<uint16_t>(args["--color-match"].asString(), [](const std::string& value)
+    {
+        return downcastLong<uint16_t>(std::stoll(value));
+    });
+    grid.m_line_match_ratios = parseList<double>(args["--line-match"].asString(), parse_double);
+
+    if (!options.m_is_sweep)
+    {
+        options.m_config_params.m_minimum_pixel_match_ratio = getSingleValue(grid.m_pixel_match_ratios, "--pixel-match");
+        options.m_config_params.m_minimum_color_match_diff = getSingleValue(grid.m_color_match_diffs, "--color-match");
+        options.m_config_params.m_minimum_line_match_ratio = getSingleValue(grid.m_line_match_ratios, "--line-match");
+    }
 
     return options;
 }
 
+void printDimensions(const std::vector<MosaicDecomposer::SplitDimensions>& dimensions)
+{
+    spdlog::info("processing finished, outputting dimensions of all recongnized mosaics");
+    for (const auto& data : dimensions)
+    {
+        spdlog::info("({:<3}; {:<3}), {:<3}x{:<3}", data.m_x, data.m_y, data.m_width, data.m_height);
+    }
+}
+
+std::unique_ptr<FrameProviderInterface> createFrameProvider(const ParseOptions& options)
+{
+    if (options.m_keyframes_only)
+    {
+        if (!options.m_is_video)
+        {
+            throw std::invalid_argument("keyframes only decoding is supported only for videos");
+        }
+
+#ifdef USE_LIBAV
+        return std::make_unique<VideoFrameProviderLibav>(options.m_file_path, true);
+#else
+        throw std::invalid_argument("keyframes only decoding requires build with USE_LIBAV enabled");
+#endif
+    }
+
+    if (options.m_is_video)
+    {
+        if (!options.m_next_file_paths.empty())
+        {
+            throw std::invalid_argument("only a single video can be decomposed at once");
+        }
+
+        return std::make_unique<VideoFrameProviderOpenCv>(options.m_file_path);
+    }
+
+    if (!options.m_next_file_paths.empty())
+    {
+        std::vector<std::string> file_paths{options.m_file_path};
+        file_paths.insert(file_paths.end(), options.m_next_file_paths.begin(), options.m_next_file_paths.end());
+
+        return std::make_unique<ImageFrameProviderOpenCv>(std::move(file_paths), options.m_read_ahead);
+    }
+
+    return std::make_unique<ImageFrameProviderOpenCv>(options.m_file_path);
+}
+
+std::vector<topology::Node> selectNodes(const ParseOptions& options)
+{
+    const auto& nodes = topology::detectNodes();
+    for (const auto& node : nodes)
+    {
+        spdlog::info("numa node {}: cpus {}", node.m_id, topology::toString(node.m_cpus));
+    }
+
+    if (options.m_affinity.rfind("node:", 0) == 0)
+    {
+        const auto node_id = downcastLong<uint32_t>(std::stoll(options.m_affinity.substr(5)));
+        const auto node = std::find_if(nodes.begin(), nodes.end(), 
+            [node_id](const topology::Node& data) { return data.m_id == node_id; });
+
+        if (node == nodes.end())
+        {
+            throw std::invalid_argument("numa node " + std::to_string(node_id) + " does not exist");
+        }
+
+        return {*node};
+    }
+
+    return nodes;
+}
+
+//! @brief Pins the calling thread to the selected node, so that threads created afterwards (i.e. workers of the pool
+//! as well as threads of the decoder) inherit it and frames are allocated in memory of the node.
+std::optional<topology::Node> placeOntoNode(const ParseOptions& options)
+{
+    if (options.m_affinity == "none")
+    {
+        return {};
+    }
+
+    const auto& nodes = selectNodes(options);
+    const auto& node = nodes.size() == 1 ? nodes.front() : topology::getCurrentNode(nodes);
+
+    if (!topology::pinCurrentThread(node.m_cpus))
+    {
+        return {};
+    }
+
+    spdlog::info("processing is placed onto numa node {}, cpus {}{}", node.m_id, topology::toString(node.m_cpus),
+        options.m_affinity == "core" ? ", each thread on its own cpu" : "");
+    return node;
+}
+
+std::size_t getThreadCount(const ParseOptions& options, const std::optional<topology::Node>& node)
+{
+    // threads beyond cpus of the node would only compete for them
+    return options.m_threads == 0 && node ? node->m_cpus.size() : options.m_threads;
+}
+
+int runSweep(const ParseOptions& options)
+{
+    std::optional<layout::Layout> ground_truth;
+    if (!options.m_ground_truth_path.empty())
+    {
+        ground_truth = layout::load(options.m_ground_truth_path);
+        if (!ground_truth)
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto& node = placeOntoNode(options);
+    auto frame_provider = createFrameProvider(options);
+    ThreadPool thread_pool(getThreadCount(options, node));
+
+    if (node && options.m_affinity == "core")
+    {
+        thread_pool.pinThreads(node->m_cpus);
+    }
+
+    ParameterSweep sweep(*frame_provider, thread_pool, options.m_config_params, options.m_sweep_grid);
+    const auto& results = sweep.run();
+
+    spdlog::info("sweep finished, outputting layouts of all configurations");
+    spdlog::info("{:<11} {:<11} {:<10} {:<7} {:<7} {}", "pixel-match", "color-match", "line-match", "mosaics", "score", "layout");
+    for (const auto& result : results)
+    {
+        const auto& score = ground_truth ? fmt::format("{:.3f}", layout::score(result.m_dimensions, *ground_truth)) : "-";
+
+        spdlog::info("{:<11} {:<11} {:<10} {:<7} {:<7} {}", result.m_params.m_minimum_pixel_match_ratio,
+            result.m_params.m_minimum_color_match_diff, result.m_params.m_minimum_line_match_ratio,
+            result.m_dimensions.size(), score, layout::toString(result.m_dimensions));
+    }
+
+    return results.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int runMerge(const ParseOptions& options)
+{
+    AnalysisState merged_state;
+
+    for (const auto& file_path : options.m_merge_paths)
+    {
+        const auto& state = AnalysisState::load(file_path);
+        if (!state || !merged_state.merge(*state))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    spdlog::info("merged {} analysis states, total amount of frames: {}, skipped duplicates: {}", 
+        options.m_merge_paths.size(), merged_state.m_processed_frames, merged_state.m_skipped_frames);
+
+    if (!options.m_export_path.empty() && !merged_state.save(options.m_export_path))
+    {
+        return EXIT_FAILURE;
+    }
+
+    MosaicDecomposer decomposer(options.m_config_params);
+    printDimensions(decomposer.calculateMosaicsDimensions(merged_state));
+    return EXIT_SUCCESS;
+}
+
+int runGenerate(const ParseOptions& options)
+{
+    SyntheticMosaicGenerator generator(options.m_synthetic_params);
+    FrameWriterOpenCv writer(options.m_file_path, options.m_is_video);
+
+    while (const auto& frame = generator.getNext())
+    {
+        if (!writer.write(*frame))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto layout_path = options.m_file_path + ".layout";
+    if (!layout::save(layout_path, generator.getLayout()))
+    {
+        return EXIT_FAILURE;
+    }
+
+    spdlog::info("generated {} with layout {}", options.m_file_path, layout::toString(generator.getLayout()));
+    return EXIT_SUCCESS;
+}
+
+int runServer(const ParseOptions& options)
+{
+#ifdef USE_SERVER
+    ServerParams params;
+    params.m_socket_path = options.m_file_path;
+    params.m_worker_count = options.m_server_workers;
+    params.m_max_queued_jobs = options.m_server_queued_jobs;
+    params.m_default_timeout = std::chrono::milliseconds(options.m_server_timeout);
+
+    // workers are spread across the nodes, each job is decoded and analyzed by a single worker
+    if (options.m_affinity != "none")
+    {
+        for (const auto& node : selectNodes(options))
+        {
+            if (options.m_affinity != "core")
+            {
+                params.m_worker_cpus.push_back(node.m_cpus);
+                continue;
+            }
+
+            for (const auto cpu : node.m_cpus)
+            {
+                params.m_worker_cpus.push_back({cpu});
+            }
+        }
+    }
+
+    DecompositionServer server(params, [](const DecompositionJob& job) -> std::unique_ptr<FrameProviderInterface>
+    {
+        if (job.m_is_video)
+        {
+            return std::make_unique<VideoFrameProviderOpenCv>(job.m_file_path);
+        }
+
+        return std::make_unique<ImageFrameProviderOpenCv>(job.m_file_path);
+    });
+
+    // signals are blocked before any thread is started, so that only the main thread receives them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    if (!server.start())
+    {
+        return EXIT_FAILURE;
+    }
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+    spdlog::info("received signal {}, stopping the server", signal);
+
+    server.stop();
+    return EXIT_SUCCESS;
+#else
+    (void)options;
+    throw std::invalid_argument("daemon mode requires build with USE_SERVER enabled (UNIX only)");
+#endif
+}
+
 int main(int argc, const char **argv)
 {
     std::map<std::string, docopt::value> args = docopt::docopt(USAGE,
@@ -93,26 +579,74 @@ int main(int argc, const char **argv)
     {
         ParseOptions options = parseArgs(args);
 
-        std::unique_ptr<FrameProviderInterface> frame_provider;
+        if (options.m_is_retune)
+        {
+            const auto& state = AnalysisState::load(options.m_file_path);
+            if (!state)
+            {
+                return EXIT_FAILURE;
+            }
+
+            MosaicDecomposer decomposer(options.m_config_params);
+            printDimensions(decomposer.calculateMosaicsDimensions(*state));
+            return EXIT_SUCCESS;
+        }
+
+        if (options.m_is_merge)
+        {
+            return runMerge(options);
+        }
+
+        if (options.m_is_sweep)
+        {
+            return runSweep(options);
+        }
+
+        if (options.m_is_generate)
+        {
+            return runGenerate(options);
+        }
 
-        if (options.m_is_video)
+        if (options.m_is_serve)
         {
-            frame_provider = std::make_unique<VideoFrameProviderOpenCv>(options.m_file_path);
+            return runServer(options);
         }
-        else
+
+        // budget includes opening of the input, as that's what the caller waits for as well
+        const auto& run_options = options.m_time_budget > 0 ? 
+            MosaicDecomposer::RunOptions::withTimeout(std::chrono::milliseconds(options.m_time_budget)) :
+            MosaicDecomposer::RunOptions{};
+
+        const auto& node = placeOntoNode(options);
+        auto frame_provider = createFrameProvider(options);
+        ThreadPool thread_pool(getThreadCount(options, node));
+
+        if (node && options.m_affinity == "core")
         {
-            frame_provider = std::make_unique<ImageFrameProviderOpenCv>(options.m_file_path);
+            thread_pool.pinThreads(node->m_cpus);
         }
 
-        MosaicDecomposer decomposer(*frame_provider, options.m_config_params);
+        MosaicDecomposer decomposer(*frame_provider, options.m_config_params, &thread_pool);
 
-        const auto& ret = decomposer.calculateMosaicsDimensions();
+        const auto& state = decomposer.analyzeFrames(run_options);
+        if (!state)
+        {
+            return EXIT_FAILURE;
+        }
 
-        spdlog::info("processing finished, outputting dimensions of all recongnized mosaics");
-        for (const auto& data : ret)
+        if (!options.m_export_path.empty() && !state->save(options.m_export_path))
         {
-            spdlog::info("({:<3}; {:<3}), {:<3}x{:<3}", data.m_x, data.m_y, data.m_width, data.m_height);
+            return EXIT_FAILURE;
         }
+
+        MosaicDecomposer::SplitMargins margins;
+        const auto& dimensions = decomposer.calculateMosaicsDimensions(*state, &margins);
+        printDimensions(decomposer.decomposeRecursively(dimensions, options.m_config_params.m_recursion_depth));
+
+        spdlog::info("layout is based on {} frames{}, weakest accepted split margin: {:.2f}, "
+            "strongest dropped split margin: {:.2f}", state->m_processed_frames, 
+            decomposer.isInterrupted() ? " (stopped by the time budget)" : "",
+            margins.m_weakest_accepted, margins.m_strongest_dropped);
     }
     catch(const std::string& exception)
     {
@@ -0,0 +1,73 @@
+#include <spdlog/spdlog.h>
+
+#include "memoryframeprovider.h"
+#include "frame.h"
+
+std::size_t FrameBuffer::getBytesPerPixel(PixelFormat format)
+{
+    return format == PixelFormat::Rgb24 || format == PixelFormat::Bgr24 ? 3 : 4;
+}
+
+bool FrameBuffer::isValid() const
+{
+    return m_data != nullptr && m_width > 0 && m_height > 0 && m_stride >= m_width * getBytesPerPixel(m_format);
+}
+
+void MemoryFrameProvider::assign(const FrameBuffer* buffers, std::size_t buffer_count)
+{
+    m_buffers.assign(buffers, buffers + buffer_count);
+    m_next_buffer = 0;
+}
+
+bool MemoryFrameProvider::isReady() const
+{
+    return !m_buffers.empty();
+}
+
+std::size_t MemoryFrameProvider::fill(std::vector<Frame>& frames, std::size_t max_frames)
+{
+    std::size_t filled_frames = 0;
+
+    for (; filled_frames < max_frames && m_next_buffer < m_buffers.size(); filled_frames++)
+    {
+        const auto& buffer = m_buffers[m_next_buffer++];
+        if (!buffer.isValid())
+        {
+            spdlog::error("frame buffer {} is not valid ({}x{}, stride {})", m_next_buffer - 1,
+                buffer.m_width, buffer.m_height, buffer.m_stride);
+            break;
+        }
+
+        const auto bytes_per_pixel = FrameBuffer::getBytesPerPixel(buffer.m_format);
+        const auto is_bgr = buffer.m_format == PixelFormat::Bgr24 || buffer.m_format == PixelFormat::Bgra32;
+
+        auto& frame = prepareFrame(frames, filled_frames, buffer.m_width, buffer.m_height);
+        for (Frame::DimensionsType row = 0; row < buffer.m_height; row++)
+        {
+            const auto* src_pixel = buffer.m_data + row * buffer.m_stride;
+            for (Frame::DimensionsType col = 0; col < buffer.m_width; col++, src_pixel += bytes_per_pixel)
+            {
+                Pixel dst_pixel;
+                dst_pixel.m_red = src_pixel[is_bgr ? 2 : 0];
+                dst_pixel.m_green = src_pixel[1];
+                dst_pixel.m_blue = src_pixel[is_bgr ? 0 : 2];
+
+                frame.set(col, row, dst_pixel);
+            }
+        }
+    }
+
+    return filled_frames;
+}
+
+bool MemoryFrameProvider::skip(uint32_t frame_count)
+{
+    if (m_buffers.size() - m_next_buffer < frame_count)
+    {
+        m_next_buffer = m_buffers.size();
+        return false;
+    }
+
+    m_next_buffer += frame_count;
+    return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "frameproviderinterface.h"
+
+enum class PixelFormat
+{
+    Rgb24,
+    Bgr24,
+    Rgba32,
+    Bgra32
+};
+
+//! @brief Describes frame stored in a memory owned by the caller, rows are stored one after another.
+struct FrameBuffer
+{
+    const uint8_t* m_data = nullptr;
+    common::DimensionsType m_width = 0;
+    common::DimensionsType m_height = 0;
+    //! @brief Amount of bytes between starts of adjacent rows, it may include padding.
+    std::size_t m_stride = 0;
+    PixelFormat m_format = PixelFormat::Rgb24;
+
+    static std::size_t getBytesPerPixel(PixelFormat format);
+
+    //! @brief Checks whether the buffer has non-zero dimensions and its stride fits whole rows.
+    bool isValid() const;
+};
+
+/**
+ * @brief Provides frames out of buffers in memory, e.g. of an application which embeds the decomposer.
+ * Buffers are not copied, so they have to stay valid until all frames are provided.
+ */
+class MemoryFrameProvider: public FrameProviderInterface
+{
+public:
+    MemoryFrameProvider() = default;
+    ~MemoryFrameProvider() = default;
+
+    //! @brief Replaces provided buffers and starts providing them from the first one,
+    //! memory of the previously assigned descriptors is reused.
+    void assign(const FrameBuffer* buffers, std::size_t buffer_count);
+
+    bool isReady() const override;
+    std::size_t fill(std::vector<Frame>& frames, std::size_t max_frames) override;
+    bool skip(uint32_t frame_count) override;
+
+private:
+    std::vector<FrameBuffer> m_buffers;
+    std::size_t m_next_buffer = 0;
+};
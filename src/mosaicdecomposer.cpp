@@ -1,27 +1,92 @@
 #include  <numeric>
+#include <algorithm>
 
 #include <spdlog/spdlog.h>
 
 #include "mosaicdecomposer.h"
+#include "duplicateframefilter.h"
 #include "frameproviderinterface.h"
+#include "threadpool.h"
 
-constexpr uint8_t MINIMUM_AMOUNT_OF_SAMPLES = 10;
+namespace
+{
+    // coarse estimates are imprecise, hence candidates are selected using a looser ratio than the splits
+    constexpr SampleAvgStorage::Ratio CANDIDATE_RATIO_PERCENTS = 75;
+
+    void markDuplicates(const std::vector<Frame>& batch, std::size_t batch_size, DuplicateFrameFilter& filter,
+        std::vector<bool>& duplicates)
+    {
+        duplicates.assign(batch_size, false);
+        for (std::size_t i = 0; i < batch_size; i++)
+        {
+            duplicates[i] = filter.isDuplicate(batch[i]);
+        }
+    }
+
+    void markChangedLines(const std::vector<Frame>& batch, std::size_t batch_size, const std::vector<bool>& duplicates,
+        linematcher::ChangeDetector& detector, std::vector<linematcher::ChangedLines>& changes)
+    {
+        // flags are kept between batches, so that their memory is reused
+        changes.resize(std::max(changes.size(), batch_size));
+        for (std::size_t i = 0; i < batch_size; i++)
+        {
+            // duplicates are not analyzed, hence changes are relative to the previous analyzed frame
+            if (!duplicates[i])
+            {
+                detector.detect(batch[i], changes[i]);
+            }
+        }
+    }
+}
 
-MosaicDecomposer::MosaicDecomposer(FrameProviderInterface& frame_provider, const ConfigParams& params) : 
-    m_frame_provider(frame_provider), 
+MosaicDecomposer::MosaicDecomposer(FrameProviderInterface& frame_provider, const ConfigParams& params,
+        ThreadPool* thread_pool) : 
+    m_frame_provider(&frame_provider), 
+    m_thread_pool(thread_pool),
     m_params(params)
 {
 }
 
+MosaicDecomposer::MosaicDecomposer(const ConfigParams& params) : 
+    m_params(params)
+{
+}
+
+MosaicDecomposer::RunOptions MosaicDecomposer::RunOptions::withTimeout(std::chrono::milliseconds timeout)
+{
+    RunOptions options;
+    options.m_deadline = std::chrono::steady_clock::now() + timeout;
+    return options;
+}
+
+bool MosaicDecomposer::RunOptions::isStopRequested() const
+{
+    return (m_cancellation != nullptr && *m_cancellation) || std::chrono::steady_clock::now() >= m_deadline;
+}
+
+void MosaicDecomposer::setBatchStorage(std::shared_ptr<BatchStorage> storage)
+{
+    m_batches = std::move(storage);
+}
+
 void MosaicDecomposer::printConfigParams() const
 {
     spdlog::info("starting printing configuration parameters");
 
     spdlog::info("{:<20} = {}", "frames_to_analyze", m_params.m_frames_to_analyze);
+    spdlog::info("{:<20} = {}", "start_frame", m_params.m_start_frame);
+    spdlog::info("{:<20} = {}", "batch_size", m_params.m_batch_size);
+    spdlog::info("{:<20} = {}", "duplicate_frame_diff", m_params.m_duplicate_frame_diff);
+    spdlog::info("{:<20} = {}", "incremental_analysis", m_params.m_incremental_analysis);
+    spdlog::info("{:<20} = {}", "coarse_line_stride", m_params.m_coarse_line_stride);
+    spdlog::info("{:<20} = {}", "refine_radius", m_params.m_refine_radius);
+    spdlog::info("{:<20} = {}", "early_exit_block", m_params.m_early_exit_block);
+    spdlog::info("{:<20} = {}", "recursion_depth", m_params.m_recursion_depth);
     spdlog::info("{:<20} = {}", "skip_front_lines", m_params.m_skip_front_lines);
     spdlog::info("{:<20} = {}", "skip_back_lines", m_params.m_skip_back_lines);
     spdlog::info("{:<20} = {}", "pixel_match_ratio", m_params.m_minimum_pixel_match_ratio);
-    spdlog::info("{:<20} = {}", "color_match_diff", m_params.m_minimum_color_match_diff);
+    spdlog::info("{:<20} = {} ({})", "color_match_diff", m_params.m_minimum_color_match_diff,
+        linematcher::isSpecialized(m_params.m_minimum_color_match_diff) ? "specialized" : "generic");
     spdlog::info("{:<20} = {}", "line_match_ratio", m_params.m_minimum_line_match_ratio);
 
     spdlog::info("finished printing configuration parameters");
@@ -29,7 +94,51 @@ void MosaicDecomposer::printConfigParams() const
 
 std::vector<MosaicDecomposer::SplitDimensions> MosaicDecomposer::calculateMosaicsDimensions()
 {
-    if (!m_frame_provider.isReady())
+    return decompose(RunOptions{}).m_dimensions;
+}
+
+MosaicDecomposer::DecompositionResult MosaicDecomposer::decompose(const RunOptions& options)
+{
+    DecompositionResult result;
+
+    const auto& state = analyzeFrames(options);
+    result.m_is_interrupted = m_is_interrupted;
+    if (!state)
+    {
+        return result;
+    }
+
+    result.m_processed_frames = state->m_processed_frames;
+    result.m_skipped_frames = state->m_skipped_frames;
+
+    const auto& dimensions = calculateMosaicsDimensions(*state, &result.m_margins);
+    result.m_dimensions = decomposeRecursively(dimensions, m_params.m_recursion_depth);
+
+    spdlog::info("weakest accepted split margin: {:.2f}, strongest dropped split margin: {:.2f}", 
+        result.m_margins.m_weakest_accepted, result.m_margins.m_strongest_dropped);
+
+    return result;
+}
+
+bool MosaicDecomposer::isInterrupted() const
+{
+    return m_is_interrupted;
+}
+
+std::optional<AnalysisState> MosaicDecomposer::analyzeFrames()
+{
+    return analyzeFrames(RunOptions{});
+}
+
+std::optional<AnalysisState> MosaicDecomposer::analyzeFrames(const RunOptions& options)
+{
+    if (m_frame_provider == nullptr)
+    {
+        spdlog::error("frame provider is not set");
+        return {};
+    }
+
+    if (!m_frame_provider->isReady())
     {
         spdlog::error("frame provider is not ready");
         return {};
@@ -37,108 +146,409 @@ std::vector<MosaicDecomposer::SplitDimensions> MosaicDecomposer::calculateMosaic
 
     printConfigParams();
 
-    std::vector<SplitPosition> potential_horizontal_splits;
-    std::vector<SplitPosition> potential_vertical_splits;
+    m_retained_frames.clear();
+    m_is_interrupted = false;
 
-    SampleAvgStorage horizontal_comparisons;
-    SampleAvgStorage vertical_comparisons;
+    const auto is_incremental = m_params.m_incremental_analysis && m_params.m_coarse_line_stride <= 1 && 
+        m_params.m_early_exit_block == 0;
 
-    Frame::DimensionsType width = 0;
-    Frame::DimensionsType height = 0;
+    if (m_params.m_incremental_analysis && !is_incremental)
+    {
+        // cached counts must be exact, while these modes produce approximate ones
+        spdlog::warn("incremental analysis is not applied along with the coarse pass or the early exit");
+    }
+
+    AnalysisState state;
 
-    uint32_t processed_frames = 0;
+    if (m_params.m_start_frame > 0 && !m_frame_provider->skip(m_params.m_start_frame))
+    {
+        // it's not an error, shards of a video past its end are merged as empty ones
+        spdlog::warn("input has less than {} frames, there is nothing to analyze", m_params.m_start_frame);
+        return state;
+    }
 
     spdlog::info("starting frame analysis");
 
-    while (const auto& frame = m_frame_provider.getNext())
+    // frames of the next batch are acquired while the current batch is being analyzed
+    auto& current_batch = m_batches->m_current_batch;
+    auto& next_batch = m_batches->m_next_batch;
+    auto current_batch_size = fillBatch(current_batch, 0);
+
+    // duplicates are recognized along with the acquisition, so that they are known before the batch is analyzed
+    DuplicateFrameFilter duplicate_filter(m_params.m_duplicate_frame_diff);
+    std::vector<bool> current_duplicates;
+    std::vector<bool> next_duplicates;
+    markDuplicates(current_batch, current_batch_size, duplicate_filter, current_duplicates);
+
+    // changed lines are found once for both orientations, along with the acquisition as well
+    linematcher::ChangeDetector change_detector;
+    std::vector<linematcher::ChangedLines> current_changes;
+    std::vector<linematcher::ChangedLines> next_changes;
+    if (is_incremental)
     {
-        if (width == 0)
+        markChangedLines(current_batch, current_batch_size, current_duplicates, change_detector, current_changes);
+    }
+
+    // each orientation is processed by a single task, so that its matcher sees the frames in order
+    linematcher::LineMatcher horizontal_matcher(linematcher::Orientation::Horizontal, m_params.m_minimum_color_match_diff);
+    linematcher::LineMatcher vertical_matcher(linematcher::Orientation::Vertical, m_params.m_minimum_color_match_diff);
+
+    while (current_batch_size > 0)
+    {
+        for (std::size_t i = 0; i < current_batch_size; i++)
         {
-            width = frame->getWidth();
+            const auto& frame = current_batch[i];
+
+            if (state.m_width == 0)
+            {
+                state.m_width = frame.getWidth();
+            }
+            else if (state.m_width != frame.getWidth())
+            {
+                spdlog::error("frames width is not consistent");
+                return {};
+            }
+
+            if (state.m_height == 0)
+            {
+                state.m_height = frame.getHeight();
+            }
+            else if (state.m_height != frame.getHeight())
+            {
+                spdlog::error("frames height is not consistent");
+                return {};
+            }
         }
-        else if (width != frame->getWidth())
+
+        const auto scheduled_frames = static_cast<uint32_t>(state.m_processed_frames + current_batch_size);
+        std::size_t next_batch_size = 0;
+
+        runTasks(3, [&](std::size_t task)
+        {
+            if (task == 0)
+            {
+                const auto is_complete = m_params.m_frames_to_analyze > 0 && 
+                    scheduled_frames >= m_params.m_frames_to_analyze;
+
+                // frames which were already acquired are still analyzed, only the acquisition is stopped
+                if (!is_complete && options.isStopRequested())
+                {
+                    m_is_interrupted = true;
+                    return;
+                }
+
+                next_batch_size = fillBatch(next_batch, scheduled_frames);
+                markDuplicates(next_batch, next_batch_size, duplicate_filter, next_duplicates);
+                if (is_incremental)
+                {
+                    markChangedLines(next_batch, next_batch_size, next_duplicates, change_detector, next_changes);
+                }
+                return;
+            }
+
+            for (std::size_t i = 0; i < current_batch_size; i++)
+            {
+                if (current_duplicates[i])
+                {
+                    continue;
+                }
+
+                const auto* changes = is_incremental ? &current_changes[i] : nullptr;
+
+                if (task == 1)
+                {
+                    processFrame(current_batch[i], horizontal_matcher, changes, state.m_horizontal);
+                }
+                else
+                {
+                    processFrame(current_batch[i], vertical_matcher, changes, state.m_vertical);
+                }
+            }
+        });
+
+        state.m_processed_frames = scheduled_frames;
+
+        // retained frames share the memory, so the provider does not reuse it for the next frames
+        for (std::size_t i = 0; i < current_batch_size && m_params.m_recursion_depth > 0; i++)
         {
-            spdlog::error("frames width is not consistent");
-            return {};
+            if (!current_duplicates[i] && m_retained_frames.size() < m_params.m_recursion_frames)
+            {
+                m_retained_frames.push_back(current_batch[i]);
+            }
         }
+        state.m_skipped_frames = static_cast<uint32_t>(state.m_skipped_frames + 
+            std::count(current_duplicates.begin(), current_duplicates.end(), true));
 
-        if (height == 0)
+        if (state.m_processed_frames == m_params.m_frames_to_analyze)
         {
-            height = frame->getHeight();
+            spdlog::info("reached requested amount of frames to analyze, stopping");
         }
-        else if (height != frame->getHeight())
+
+        if (m_is_interrupted)
         {
-            spdlog::error("frames height is not consistent");
-            return {};
+            spdlog::warn("analysis was stopped by run options, layout is based only on the frames analyzed so far");
         }
 
-        processFrame(*frame, potential_horizontal_splits, horizontal_comparisons);
+        std::swap(current_batch, next_batch);
+        std::swap(current_duplicates, next_duplicates);
+        std::swap(current_changes, next_changes);
+        current_batch_size = next_batch_size;
+    }
 
-        const auto& rotated = frame->rotate90();
-        processFrame(rotated, potential_vertical_splits, vertical_comparisons);
+    spdlog::info("finished analyzing frames, total amount: {}, skipped duplicates: {}", 
+        state.m_processed_frames, state.m_skipped_frames);
 
-        if (++processed_frames == m_params.m_frames_to_analyze)
-        {
-            spdlog::info("reached requested amount of frames to analyze, stopping");
-            break;
-        }
+    if (m_params.m_incremental_analysis || m_params.m_coarse_line_stride > 1 || m_params.m_early_exit_block > 0)
+    {
+        spdlog::info("counted matches of {} lines at full resolution, reused {} unchanged lines, estimated {} lines", 
+            horizontal_matcher.getCountedLines() + vertical_matcher.getCountedLines(),
+            horizontal_matcher.getReusedLines() + vertical_matcher.getReusedLines(),
+            horizontal_matcher.getEstimatedLines() + vertical_matcher.getEstimatedLines());
+    }
+
+    return state;
+}
+
+std::size_t MosaicDecomposer::fillBatch(std::vector<Frame>& batch, uint32_t scheduled_frames) const
+{
+    std::size_t max_frames = std::max<std::size_t>(m_params.m_batch_size, 1);
+
+    if (m_params.m_frames_to_analyze > 0)
+    {
+        max_frames = std::min<std::size_t>(max_frames, m_params.m_frames_to_analyze - scheduled_frames);
+    }
+
+    if (max_frames == 0)
+    {
+        return 0;
+    }
+
+    return m_frame_provider->fill(batch, max_frames);
+}
+
+void MosaicDecomposer::runTasks(std::size_t task_count, const std::function<void(std::size_t)>& task) const
+{
+    if (m_thread_pool)
+    {
+        m_thread_pool->parallelFor(task_count, task);
+        return;
     }
 
-    spdlog::info("finished analyzing frames, total amount: {}", processed_frames);
+    for (std::size_t i = 0; i < task_count; i++)
+    {
+        task(i);
+    }
+}
+
+std::vector<MosaicDecomposer::SplitDimensions> MosaicDecomposer::calculateMosaicsDimensions(
+    const AnalysisState& state, SplitMargins* margins) const
+{
+    if (state.m_width == 0 || state.m_height == 0)
+    {
+        spdlog::error("analysis state does not contain any analyzed frame");
+        return {};
+    }
 
     spdlog::info("starting processing potential horizontal splits");
-    auto collated_horizontal_splits = collateAdjacentSplits(potential_horizontal_splits);
-    auto filtered_horizontal_splits = dropFalsePositiveSplits(collated_horizontal_splits);
+    auto collated_horizontal_splits = collateAdjacentSplits(state.m_horizontal.m_split_histogram);
+    auto filtered_horizontal_splits = dropFalsePositiveSplits(collated_horizontal_splits, margins);
 
     spdlog::info("starting processing potential vertical splits");
-    auto collated_vertical_splits = collateAdjacentSplits(potential_vertical_splits);
-    auto filtered_vertical_splits = dropFalsePositiveSplits(collated_vertical_splits);
+    auto collated_vertical_splits = collateAdjacentSplits(state.m_vertical.m_split_histogram);
+    auto filtered_vertical_splits = dropFalsePositiveSplits(collated_vertical_splits, margins);
 
     // front and back positions must be manually added in order to calculate mosaic dimensions
     filtered_horizontal_splits.insert(filtered_horizontal_splits.begin(), 0);
-    filtered_horizontal_splits.push_back(height);
+    filtered_horizontal_splits.push_back(state.m_height);
 
     filtered_vertical_splits.insert(filtered_vertical_splits.begin(), 0);
-    filtered_vertical_splits.push_back(width);
+    filtered_vertical_splits.push_back(state.m_width);
 
     return translate(filtered_horizontal_splits, filtered_vertical_splits);
 }
 
-void MosaicDecomposer::processFrame(const Frame& frame, std::vector<SplitPosition>& potential_splits, 
-    SampleAvgStorage& comparisons) const
+std::vector<MosaicDecomposer::SplitDimensions> MosaicDecomposer::decomposeRecursively(
+    const std::vector<SplitDimensions>& mosaics, uint8_t depth) const
 {
-    potential_splits.resize(frame.getHeight());
+    if (depth == 0 || m_retained_frames.empty())
+    {
+        return mosaics;
+    }
 
-    // micro optimization since these methods might need to transpose the size
-    const auto frame_width = frame.getWidth();
-    const auto frame_height = frame.getHeight();
+    const auto is_decomposable = [this](const SplitDimensions& mosaic)
+    {
+        return mosaic.m_width >= m_params.m_minimum_recursive_size && mosaic.m_height >= m_params.m_minimum_recursive_size;
+    };
 
-    const auto length = frame_height - (m_params.m_skip_back_lines ? m_params.m_skip_back_lines : 1);
-    for (SplitPosition i = m_params.m_skip_front_lines; i < length; i++)
+    struct Region
     {
-        Frame::DimensionsType matched_pixels = 0;
+        SplitDimensions m_mosaic;
+        AnalysisState m_state;
+        linematcher::LineMatcher m_horizontal_matcher;
+        linematcher::LineMatcher m_vertical_matcher;
+    };
 
-        for (SplitPosition j = 0; j < frame_width; j++)
+    std::vector<Region> regions;
+    for (const auto& mosaic : mosaics)
+    {
+        if (is_decomposable(mosaic))
         {
-            auto current_pixel = frame.get(j, i);
-            auto next_pixel = frame.get(j, static_cast<SplitPosition>(i + 1));
+            regions.push_back(Region{mosaic, AnalysisState{}, 
+                linematcher::LineMatcher(linematcher::Orientation::Horizontal, m_params.m_minimum_color_match_diff),
+                linematcher::LineMatcher(linematcher::Orientation::Vertical, m_params.m_minimum_color_match_diff)});
+        }
+    }
 
-            if (current_pixel.coarseCompare(next_pixel, m_params.m_minimum_color_match_diff))
-            {
-                matched_pixels++;
-            }
+    spdlog::info("starting recursive decomposition of {} mosaics using {} frames", regions.size(), m_retained_frames.size());
+
+    // all regions of a frame are analyzed at once, so that each retained frame is accessed only once per level
+    for (const auto& frame : m_retained_frames)
+    {
+        runTasks(regions.size(), [&](std::size_t index)
+        {
+            auto& region = regions[index];
+            const auto& mosaic = region.m_mosaic;
+            const auto& view = frame.crop(mosaic.m_x, mosaic.m_y, mosaic.m_width, mosaic.m_height);
+
+            processFrame(view, region.m_horizontal_matcher, nullptr, region.m_state.m_horizontal);
+            processFrame(view, region.m_vertical_matcher, nullptr, region.m_state.m_vertical);
+            region.m_state.m_processed_frames++;
+        });
+    }
+
+    std::vector<SplitDimensions> decomposed;
+    auto region = regions.begin();
+
+    for (const auto& mosaic : mosaics)
+    {
+        if (!is_decomposable(mosaic))
+        {
+            decomposed.push_back(mosaic);
+            continue;
         }
 
-        const auto current_line_match_rate = static_cast<double>(matched_pixels) / frame_width * 100.;
-        const auto is_rate_below_acceptable = current_line_match_rate < 
-                (comparisons.getTotalAverage() / m_params.m_minimum_pixel_match_ratio);
+        region->m_state.m_width = mosaic.m_width;
+        region->m_state.m_height = mosaic.m_height;
+        auto nested_mosaics = calculateMosaicsDimensions(region->m_state);
+        region++;
 
-        if (comparisons.getSampleCount() > MINIMUM_AMOUNT_OF_SAMPLES && is_rate_below_acceptable)
+        if (nested_mosaics.size() <= 1)
         {
-            potential_splits[i]++;
+            decomposed.push_back(mosaic);
+            continue;
+        }
+
+        spdlog::info("mosaic ({}; {}), {}x{} consists of {} nested mosaics", mosaic.m_x, mosaic.m_y, 
+            mosaic.m_width, mosaic.m_height, nested_mosaics.size());
+
+        for (auto& nested_mosaic : nested_mosaics)
+        {
+            nested_mosaic.m_x = static_cast<SplitPosition>(nested_mosaic.m_x + mosaic.m_x);
+            nested_mosaic.m_y = static_cast<SplitPosition>(nested_mosaic.m_y + mosaic.m_y);
+        }
+
+        const auto& deeper_mosaics = decomposeRecursively(nested_mosaics, static_cast<uint8_t>(depth - 1));
+        decomposed.insert(decomposed.end(), deeper_mosaics.begin(), deeper_mosaics.end());
+    }
+
+    return decomposed;
+}
+
+void MosaicDecomposer::processFrame(const Frame& frame, linematcher::LineMatcher& line_matcher,
+    const linematcher::ChangedLines* changes, AnalysisState::OrientationState& state) const
+{
+    if (frame.isTransposed())
+    {
+        spdlog::error("transposed frames are not supported, orientation shall be used instead");
+        return;
+    }
+
+    // lines of the vertical orientation are columns of the frame
+    const auto is_horizontal = line_matcher.getOrientation() == linematcher::Orientation::Horizontal;
+    const auto line_width = is_horizontal ? frame.getWidth() : frame.getHeight();
+    const auto line_count = is_horizontal ? frame.getHeight() : frame.getWidth();
+
+    state.m_split_histogram.resize(line_count);
+
+    const auto length = line_count - (m_params.m_skip_back_lines ? m_params.m_skip_back_lines : 1);
+    const auto first_line = m_params.m_skip_front_lines;
+    const auto end_line = static_cast<SplitPosition>(std::max<int>(length, first_line));
+
+    if (m_params.m_coarse_line_stride > 1)
+    {
+        processFrameCoarseToFine(frame, line_matcher, first_line, end_line, line_width, state);
+        return;
+    }
+
+    const auto pixel_match_ratio = SampleAvgStorage::toFixedPointRatio(m_params.m_minimum_pixel_match_ratio);
+
+    if (m_params.m_early_exit_block > 0)
+    {
+        for (SplitPosition i = first_line; i < end_line; i++)
+        {
+            state.addLineMatch(i, countMatchedPixels(frame, line_matcher, i, state, pixel_match_ratio), 
+                line_width, pixel_match_ratio);
+        }
+        return;
+    }
+
+    const auto& matched_pixels = line_matcher.countMatchedPixels(frame, first_line, end_line, changes);
+    for (SplitPosition i = first_line; i < end_line; i++)
+    {
+        state.addLineMatch(i, matched_pixels[i], line_width, pixel_match_ratio);
+    }
+}
+
+Frame::DimensionsType MosaicDecomposer::countMatchedPixels(const Frame& frame, linematcher::LineMatcher& line_matcher, 
+    SplitPosition line, const AnalysisState::OrientationState& state, SampleAvgStorage::Ratio pixel_match_ratio) const
+{
+    if (m_params.m_early_exit_block > 0 && state.isAverageSettled())
+    {
+        return line_matcher.estimateMatchedPixels(frame, line, m_params.m_early_exit_block, 
+            state.m_comparisons, pixel_match_ratio);
+    }
+
+    return line_matcher.countMatchedPixels(frame, line);
+}
+
+void MosaicDecomposer::processFrameCoarseToFine(const Frame& frame, linematcher::LineMatcher& line_matcher,
+    SplitPosition first_line, SplitPosition end_line, Frame::DimensionsType line_width, 
+    AnalysisState::OrientationState& state) const
+{
+    const auto stride = m_params.m_coarse_line_stride;
+    const auto sampled_pixels = static_cast<Frame::DimensionsType>((line_width + stride - 1) / stride);
+    const auto pixel_match_ratio = SampleAvgStorage::toFixedPointRatio(m_params.m_minimum_pixel_match_ratio);
+    const auto candidate_ratio = pixel_match_ratio * CANDIDATE_RATIO_PERCENTS / 100;
+
+    // average is not reliable until at least a whole frame contributed to it, such frames are refined completely
+    const auto is_bootstrapping = !state.isAverageSettled();
+
+    std::vector<Frame::DimensionsType> sampled_matches(state.m_split_histogram.size());
+    std::vector<bool> is_refined(state.m_split_histogram.size(), is_bootstrapping);
+
+    for (auto i = first_line; i < end_line && !is_bootstrapping; i++)
+    {
+        sampled_matches[i] = line_matcher.countSampledPixels(frame, i, stride);
+
+        if (state.m_comparisons.isBelowAverage(sampled_matches[i], sampled_pixels, candidate_ratio))
+        {
+            const auto band_begin = std::max<int>(first_line, i - m_params.m_refine_radius);
+            const auto band_end = std::min<int>(end_line, i + m_params.m_refine_radius + 1);
+            std::fill(is_refined.begin() + band_begin, is_refined.begin() + band_end, true);
+        }
+    }
+
+    for (auto i = first_line; i < end_line; i++)
+    {
+        if (is_refined[i])
+        {
+            state.addLineMatch(i, countMatchedPixels(frame, line_matcher, i, state, pixel_match_ratio), 
+                line_width, pixel_match_ratio);
+        }
+        else
+        {
+            state.m_comparisons.addSample(sampled_matches[i], sampled_pixels);
         }
-        
-        comparisons.addSample(current_line_match_rate);
     }
 }
 
@@ -154,14 +564,14 @@ std::vector<MosaicDecomposer::SplitOccurenceData> MosaicDecomposer::collateAdjac
         {
             if (current_value < next_value)
             {
-                next_value = static_cast<SplitOccurenceType>(next_value + current_value);
+                next_value += current_value;
                 current_value = 0;
                 spdlog::info("collated value of position {} into position {}, new match count is {}", 
                         curr_index, next_index, next_value);
             }
             else
             {
-                current_value = static_cast<SplitOccurenceType>(current_value + next_value);
+                current_value += next_value;
                 next_value = 0;
                 spdlog::info("collated value of position {} into position {}, new match count is {}", 
                         next_index, curr_index, current_value);
@@ -203,7 +613,7 @@ std::vector<MosaicDecomposer::SplitOccurenceData> MosaicDecomposer::collateAdjac
 }
 
 std::vector<MosaicDecomposer::SplitPosition> MosaicDecomposer::dropFalsePositiveSplits(
-    const std::vector<SplitOccurenceData>& potential_splits) const
+    const std::vector<SplitOccurenceData>& potential_splits, SplitMargins* margins) const
 {
     std::vector<SplitPosition> filtered_splits;
 
@@ -218,12 +628,24 @@ std::vector<MosaicDecomposer::SplitPosition> MosaicDecomposer::dropFalsePositive
     for (const auto& data : potential_splits)
     {
         const auto minimum_count = total_average / m_params.m_minimum_line_match_ratio;
+        const auto margin = data.m_match_count / minimum_count;
+
         if ( data.m_match_count >= minimum_count)
         {
             filtered_splits.push_back(data.m_position);
+
+            if (margins && (margins->m_weakest_accepted == 0. || margin < margins->m_weakest_accepted))
+            {
+                margins->m_weakest_accepted = margin;
+            }
         }
         else
         {
+            if (margins)
+            {
+                margins->m_strongest_dropped = std::max(margins->m_strongest_dropped, margin);
+            }
+
             spdlog::info("position {} is considered a false positive, occured only {} times, vs average of {}", 
                         data.m_position, data.m_match_count, total_average);
         }
@@ -269,20 +691,3 @@ std::vector<MosaicDecomposer::SplitDimensions> MosaicDecomposer::translate(
     return splits;
 }
 
-
-void MosaicDecomposer::SampleAvgStorage::addSample(double sample)
-{
-    const auto previous_sum = m_average_match_rate * static_cast<double>(m_total_samples);
-    m_total_samples++;
-    m_average_match_rate = (previous_sum + sample) / static_cast<double>(m_total_samples);
-}
-
-double MosaicDecomposer::SampleAvgStorage::getTotalAverage() const 
-{
-    return m_average_match_rate;
-}
-
-uint64_t MosaicDecomposer::SampleAvgStorage::getSampleCount() const
-{
-    return m_total_samples;
-}
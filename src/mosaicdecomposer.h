@@ -1,13 +1,21 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 #include <cstdint>
 
+#include "analysisstate.h"
 #include "configparams.h"
 #include "frame.h"
+#include "linematcher.h"
 
 class FrameProviderInterface;
+class ThreadPool;
 
 /**
  * @brief Core algorithm of mosaic decomposition. It can be summarized with the 3 following steps:
@@ -28,25 +36,89 @@ public:
         Frame::DimensionsType m_height{};
     };
 
-    MosaicDecomposer(FrameProviderInterface& frame_provider, const ConfigParams& params = ConfigParams{});
+    //! @brief Frames of batches which are being acquired and analyzed, they are kept between analyses,
+    //! so that memory of their frames is reused by the next one.
+    struct BatchStorage
+    {
+        std::vector<Frame> m_current_batch;
+        std::vector<Frame> m_next_batch;
+    };
+
+    /**
+     * @brief Bounds latency of a single decomposition. Once the deadline passes or the cancellation is requested,
+     * no further frames are acquired and the layout is calculated out of the frames analyzed so far.
+     * @note it's checked before acquisition of each batch of frames, so the first batch is always analyzed and
+     * the decomposition may overrun the deadline by the time needed to analyze a single batch.
+     */
+    struct RunOptions
+    {
+        std::chrono::steady_clock::time_point m_deadline = std::chrono::steady_clock::time_point::max();
+
+        //! @brief Optional flag which is set (from any thread) to stop the decomposition.
+        const std::atomic<bool>* m_cancellation = nullptr;
+
+        static RunOptions withTimeout(std::chrono::milliseconds timeout);
+
+        bool isStopRequested() const;
+    };
+
+    //! @brief Margins are ratios of split occurrences to the minimum amount of occurrences of a split (derived from
+    //! line match ratio), margins close to 1 on either side mean that the layout may change with more frames.
+    struct SplitMargins
+    {
+        //! @brief The lowest margin of the accepted splits, 0 when there is no accepted split.
+        double m_weakest_accepted = 0.;
+        //! @brief The highest margin of the splits dropped as false positives, 0 when there is no dropped split.
+        double m_strongest_dropped = 0.;
+    };
+
+    struct DecompositionResult
+    {
+        std::vector<SplitDimensions> m_dimensions;
+        //! @brief Whether the decomposition was stopped by run options before the input was analyzed completely.
+        bool m_is_interrupted = false;
+        uint32_t m_processed_frames = 0;
+        uint32_t m_skipped_frames = 0;
+        //! @note margins describe only the top level splits, not the nested ones.
+        SplitMargins m_margins;
+    };
+
+    //! @note when thread pool is supplied, frame acquisition and analysis of both orientations run in parallel.
+    MosaicDecomposer(FrameProviderInterface& frame_provider, const ConfigParams& params = ConfigParams{},
+        ThreadPool* thread_pool = nullptr);
+    //! @brief Creates decomposer which is not attached to any frame provider, 
+    //! it can only calculate dimensions out of previously collected analysis state.
+    explicit MosaicDecomposer(const ConfigParams& params);
     ~MosaicDecomposer() = default;
 
     std::vector<SplitDimensions> calculateMosaicsDimensions();
 
-private:
-    struct SampleAvgStorage
-    {
-        void addSample(double sample);
+    //! @brief Decomposes frames within limits of the run options, result is empty when no frame was analyzed.
+    DecompositionResult decompose(const RunOptions& options);
 
-        uint64_t getSampleCount() const;
-        double getTotalAverage() const;
+    //! @brief Performs only the first step of the algorithm, i.e. collects potential splits out of all frames.
+    //! @note when recursion is enabled, some of the analyzed frames are retained for decomposeRecursively().
+    std::optional<AnalysisState> analyzeFrames();
+    std::optional<AnalysisState> analyzeFrames(const RunOptions& options);
 
-    private:
-        double m_average_match_rate = 0.f;
-        uint64_t m_total_samples = 0;
-    };
+    //! @brief Whether the last analyzeFrames() was stopped by its run options.
+    bool isInterrupted() const;
+
+    //! @brief Performs the remaining steps of the algorithm on previously collected analysis state.
+    //! @param margins when supplied, margins of the splits are stored into it.
+    std::vector<SplitDimensions> calculateMosaicsDimensions(const AnalysisState& state, 
+        SplitMargins* margins = nullptr) const;
+
+    //! @brief Repeats split detection inside of each of the mosaics using views of the frames retained by 
+    //! analyzeFrames(), mosaics which are split further are replaced with the nested ones.
+    std::vector<SplitDimensions> decomposeRecursively(const std::vector<SplitDimensions>& mosaics, uint8_t depth) const;
 
-    using SplitOccurenceType = uint16_t;
+    //! @brief Replaces storage of batches, e.g. by one which is shared by subsequent decomposers of a single thread.
+    //! @note storage must not be used by multiple decomposers at once.
+    void setBatchStorage(std::shared_ptr<BatchStorage> storage);
+
+private:
+    using SplitOccurenceType = common::SplitOccurenceType;
 
     struct SplitOccurenceData
     {
@@ -57,13 +129,25 @@ private:
     };
 
     void printConfigParams() const;
-    void processFrame(const Frame& frame, std::vector<SplitPosition>& potential_splits, SampleAvgStorage& comparisons) const;
+    std::size_t fillBatch(std::vector<Frame>& batch, uint32_t scheduled_frames) const;
+    void runTasks(std::size_t task_count, const std::function<void(std::size_t)>& task) const;
+    void processFrame(const Frame& frame, linematcher::LineMatcher& line_matcher, const linematcher::ChangedLines* changes,
+        AnalysisState::OrientationState& state) const;
+    Frame::DimensionsType countMatchedPixels(const Frame& frame, linematcher::LineMatcher& line_matcher, 
+        SplitPosition line, const AnalysisState::OrientationState& state, SampleAvgStorage::Ratio pixel_match_ratio) const;
+    void processFrameCoarseToFine(const Frame& frame, linematcher::LineMatcher& line_matcher, SplitPosition first_line,
+        SplitPosition end_line, Frame::DimensionsType line_width, AnalysisState::OrientationState& state) const;
     std::vector<SplitOccurenceData> collateAdjacentSplits(std::vector<SplitOccurenceType> potential_splits) const;
-    std::vector<SplitPosition> dropFalsePositiveSplits(const std::vector<SplitOccurenceData>& potential_splits) const;
+    std::vector<SplitPosition> dropFalsePositiveSplits(const std::vector<SplitOccurenceData>& potential_splits,
+        SplitMargins* margins) const;
 
     std::vector<SplitDimensions> translate(
         const std::vector<SplitPosition>& horizontal_positions, const std::vector<SplitPosition>& vertical_positions) const;
 
-    FrameProviderInterface& m_frame_provider;
+    FrameProviderInterface* const m_frame_provider = nullptr;
+    ThreadPool* const m_thread_pool = nullptr;
     const ConfigParams m_params;
+    std::vector<Frame> m_retained_frames;
+    bool m_is_interrupted = false;
+    std::shared_ptr<BatchStorage> m_batches = std::make_shared<BatchStorage>();
 };
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+#include "parametersweep.h"
+#include "duplicateframefilter.h"
+#include "frame.h"
+#include "frameproviderinterface.h"
+#include "mosaicdecomposer.h"
+#include "threadpool.h"
+
+namespace
+{
+    // maximum color difference of two pixels, when all channels differ completely
+    constexpr std::size_t MAXIMUM_COLOR_DIFF = 3 * std::numeric_limits<Pixel::Color>::max();
+
+    template <class ValueType>
+    void normalize(std::vector<ValueType>& values, ValueType default_value)
+    {
+        if (values.empty())
+        {
+            values.push_back(default_value);
+        }
+
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+    }
+}
+
+ParameterSweep::ParameterSweep(FrameProviderInterface& frame_provider, ThreadPool& thread_pool,
+        const ConfigParams& params, const SweepGrid& grid) :
+    m_frame_provider(frame_provider),
+    m_thread_pool(thread_pool),
+    m_params(params),
+    m_grid(grid)
+{
+    normalize(m_grid.m_pixel_match_ratios, m_params.m_minimum_pixel_match_ratio);
+    normalize(m_grid.m_color_match_diffs, m_params.m_minimum_color_match_diff);
+    normalize(m_grid.m_line_match_ratios, m_params.m_minimum_line_match_ratio);
+
+    if (m_grid.m_color_match_diffs.size() >= std::numeric_limits<uint8_t>::max())
+    {
+        throw std::invalid_argument("too many color match diffs requested: " +
+            std::to_string(m_grid.m_color_match_diffs.size()));
+    }
+
+    m_color_buckets.resize(MAXIMUM_COLOR_DIFF + 1);
+    for (std::size_t diff = 0; diff < m_color_buckets.size(); diff++)
+    {
+        const auto& bucket = std::lower_bound(m_grid.m_color_match_diffs.begin(), m_grid.m_color_match_diffs.end(), diff);
+        m_color_buckets[diff] = static_cast<uint8_t>(std::distance(m_grid.m_color_match_diffs.begin(), bucket));
+    }
+
+    for (const auto pixel_match_ratio : m_grid.m_pixel_match_ratios)
+    {
+        for (std::size_t color_index = 0; color_index < m_grid.m_color_match_diffs.size(); color_index++)
+        {
+            m_configurations.push_back(Configuration{color_index, pixel_match_ratio, AnalysisState{}});
+        }
+    }
+}
+
+std::vector<ParameterSweep::Result> ParameterSweep::run()
+{
+    if (!m_frame_provider.isReady())
+    {
+        spdlog::error("frame provider is not ready");
+        return {};
+    }
+
+    spdlog::info("starting parameter sweep of {} configurations using {} threads",
+        m_configurations.size() * m_grid.m_line_match_ratios.size(), m_thread_pool.getThreadCount());
+
+    Frame::DimensionsType width = 0;
+    Frame::DimensionsType height = 0;
+    uint32_t processed_frames = 0;
+    uint32_t skipped_frames = 0;
+    DuplicateFrameFilter duplicate_filter(m_params.m_duplicate_frame_diff);
+
+    if (m_params.m_start_frame > 0 && !m_frame_provider.skip(m_params.m_start_frame))
+    {
+        spdlog::error("input has less than {} frames, there is nothing to sweep", m_params.m_start_frame);
+        return {};
+    }
+
+    while (const auto& frame = m_frame_provider.getNext())
+    {
+        if (width == 0 && height == 0)
+        {
+            width = frame->getWidth();
+            height = frame->getHeight();
+        }
+        else if (width != frame->getWidth() || height != frame->getHeight())
+        {
+            spdlog::error("frames dimensions are not consistent");
+            return {};
+        }
+
+        if (duplicate_filter.isDuplicate(*frame))
+        {
+            skipped_frames++;
+        }
+        else
+        {
+            processFrame(*frame, &AnalysisState::m_horizontal);
+            processFrame(frame->rotate90(), &AnalysisState::m_vertical);
+        }
+
+        if (++processed_frames == m_params.m_frames_to_analyze)
+        {
+            spdlog::info("reached requested amount of frames to analyze, stopping");
+            break;
+        }
+    }
+
+    spdlog::info("finished analyzing frames, total amount: {}, skipped duplicates: {}", processed_frames, skipped_frames);
+
+    std::vector<Result> results;
+
+    for (auto& configuration : m_configurations)
+    {
+        configuration.m_state.m_width = width;
+        configuration.m_state.m_height = height;
+        configuration.m_state.m_processed_frames = processed_frames;
+        configuration.m_state.m_skipped_frames = skipped_frames;
+
+        for (const auto line_match_ratio : m_grid.m_line_match_ratios)
+        {
+            auto params = m_params;
+            params.m_minimum_pixel_match_ratio = configuration.m_pixel_match_ratio;
+            params.m_minimum_color_match_diff = m_grid.m_color_match_diffs[configuration.m_color_index];
+            params.m_minimum_line_match_ratio = line_match_ratio;
+
+            MosaicDecomposer decomposer(params);
+            results.push_back(Result{params, decomposer.calculateMosaicsDimensions(configuration.m_state)});
+        }
+    }
+
+    return results;
+}
+
+void ParameterSweep::processFrame(const Frame& frame, AnalysisState::OrientationState AnalysisState::*orientation)
+{
+    const auto frame_width = frame.getWidth();
+    const auto frame_height = frame.getHeight();
+
+    for (auto& configuration : m_configurations)
+    {
+        (configuration.m_state.*orientation).m_split_histogram.resize(frame_height);
+    }
+
+    const auto first_line = m_params.m_skip_front_lines;
+    const auto length = frame_height - (m_params.m_skip_back_lines ? m_params.m_skip_back_lines : 1);
+    if (length <= first_line)
+    {
+        return;
+    }
+
+    const auto line_count = static_cast<std::size_t>(length - first_line);
+    const auto color_count = m_grid.m_color_match_diffs.size();
+
+    m_matched_pixels.assign(line_count * color_count, 0);
+
+    // lines are independent of each other while counting, so they are split into chunks across the threads
+    const auto chunk_count = std::min(line_count, m_thread_pool.getThreadCount() * 4);
+    m_thread_pool.parallelFor(chunk_count, [&](std::size_t chunk)
+    {
+        std::vector<Frame::DimensionsType> diff_histogram(color_count + 1);
+
+        const auto chunk_begin = line_count * chunk / chunk_count;
+        const auto chunk_end = line_count * (chunk + 1) / chunk_count;
+
+        for (auto line_index = chunk_begin; line_index < chunk_end; line_index++)
+        {
+            const auto i = static_cast<Frame::DimensionsType>(first_line + line_index);
+            std::fill(diff_histogram.begin(), diff_histogram.end(), 0);
+
+            for (Frame::DimensionsType j = 0; j < frame_width; j++)
+            {
+                const auto current_pixel = frame.get(j, i);
+                const auto next_pixel = frame.get(j, static_cast<Frame::DimensionsType>(i + 1));
+
+                const auto diff = std::abs(current_pixel.m_red - next_pixel.m_red) +
+                    std::abs(current_pixel.m_green - next_pixel.m_green) +
+                    std::abs(current_pixel.m_blue - next_pixel.m_blue);
+
+                diff_histogram[m_color_buckets[static_cast<std::size_t>(diff)]]++;
+            }
+
+            // pixel matches the color diff when it falls into its bucket or into any of the smaller ones
+            Frame::DimensionsType matched_pixels = 0;
+            for (std::size_t color_index = 0; color_index < color_count; color_index++)
+            {
+                matched_pixels = static_cast<Frame::DimensionsType>(matched_pixels + diff_histogram[color_index]);
+                m_matched_pixels[line_index * color_count + color_index] = matched_pixels;
+            }
+        }
+    });
+
+    // split detection depends on the average of preceding lines, hence each configuration processes all of its lines sequentially
+    m_thread_pool.parallelFor(m_configurations.size(), [&](std::size_t configuration_index)
+    {
+        auto& configuration = m_configurations[configuration_index];
+        auto& state = configuration.m_state.*orientation;
+        const auto pixel_match_ratio = SampleAvgStorage::toFixedPointRatio(configuration.m_pixel_match_ratio);
+
+        for (std::size_t line_index = 0; line_index < line_count; line_index++)
+        {
+            state.addLineMatch(static_cast<Frame::DimensionsType>(first_line + line_index),
+                m_matched_pixels[line_index * color_count + configuration.m_color_index],
+                frame_width, pixel_match_ratio);
+        }
+    });
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "analysisstate.h"
+#include "configparams.h"
+#include "layout.h"
+
+class Frame;
+class FrameProviderInterface;
+class ThreadPool;
+
+/*!
+ * @brief Defines values of parameters to be evaluated, every combination of them is a separate configuration.
+ * @note empty list means that the value of the base configuration is used.
+ */
+struct SweepGrid
+{
+    std::vector<double> m_pixel_match_ratios;
+    std::vector<uint16_t> m_color_match_diffs;
+    std::vector<double> m_line_match_ratios;
+};
+
+/**
+ * @brief Evaluates multiple configurations of the algorithm, each frame is decoded only once.
+ * Matching pixels of every line are counted for all color match diffs at once out of the line's histogram
+ * of pixel differences, then each pair of color match diff and pixel match ratio collects its own analysis state
+ * in parallel. Line match ratios are applied afterwards on the collected states, since they don't affect analysis.
+ */
+class ParameterSweep
+{
+public:
+    struct Result
+    {
+        ConfigParams m_params;
+        layout::Layout m_dimensions;
+    };
+
+    ParameterSweep(FrameProviderInterface& frame_provider, ThreadPool& thread_pool,
+        const ConfigParams& params, const SweepGrid& grid);
+    ~ParameterSweep() = default;
+
+    //! @return results of all configurations, ordered by pixel match ratio, color match diff and line match ratio
+    std::vector<Result> run();
+
+private:
+    struct Configuration
+    {
+        std::size_t m_color_index;
+        double m_pixel_match_ratio;
+        AnalysisState m_state;
+    };
+
+    void processFrame(const Frame& frame, AnalysisState::OrientationState AnalysisState::*orientation);
+
+    FrameProviderInterface& m_frame_provider;
+    ThreadPool& m_thread_pool;
+    const ConfigParams m_params;
+    SweepGrid m_grid;
+
+    // maps color difference of two pixels to the index of the smallest color match diff which accepts it
+    std::vector<uint8_t> m_color_buckets;
+    std::vector<Configuration> m_configurations;
+    // amount of matched pixels per line and color match diff of the currently processed frame
+    std::vector<common::DimensionsType> m_matched_pixels;
+};
@@ -11,4 +11,25 @@ struct Pixel
     Color m_blue{};
 
     bool coarseCompare(const Pixel& other, uint16_t acceptable_color_deviation = 80) const;
+
+    //! @brief Compile time variant of coarseCompare(), lets the compiler fold the deviation into the comparison.
+    template <uint16_t AcceptableColorDeviation>
+    constexpr bool coarseCompare(const Pixel& other) const
+    {
+        return colorDifference(other) <= AcceptableColorDeviation;
+    }
+
+    //! @brief Calculates sum of absolute differences of all color channels.
+    constexpr uint16_t colorDifference(const Pixel& other) const
+    {
+        return static_cast<uint16_t>(channelDifference(m_red, other.m_red) +
+            channelDifference(m_green, other.m_green) +
+            channelDifference(m_blue, other.m_blue));
+    }
+
+private:
+    static constexpr int channelDifference(Color first, Color second)
+    {
+        return first > second ? first - second : second - first;
+    }
 };
@@ -0,0 +1,404 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "decomposerapiwrapper.h"
+
+namespace
+{
+    struct DecomposerObject
+    {
+        PyObject_HEAD
+        md::Decomposer* m_decomposer;
+        // decomposer must not be used by several threads at once, it's checked while holding the GIL
+        bool m_is_busy;
+    };
+
+    /**
+     * @brief Frames exported by python objects through the buffer protocol, they are not copied.
+     * Buffers are held until the object is destroyed, so the analysis may run without the GIL.
+     */
+    class ExportedFrames
+    {
+    public:
+        ExportedFrames() = default;
+        ExportedFrames(const ExportedFrames&) = delete;
+        ExportedFrames& operator=(const ExportedFrames&) = delete;
+
+        ~ExportedFrames()
+        {
+            for (auto& view : m_views)
+            {
+                PyBuffer_Release(&view);
+            }
+        }
+
+        //! @brief Adds frames of a HxWxC or NxHxWxC array of bytes, C is either 3 or 4 channels.
+        //! @return false with a python exception set when the object is not such an array.
+        bool add(PyObject* object, bool is_bgr)
+        {
+            // views are released by their address, so they are kept in a container which doesn't move them
+            auto& view = m_views.emplace_back();
+            if (PyObject_GetBuffer(object, &view, PyBUF_RECORDS_RO) != 0)
+            {
+                m_views.pop_back();
+                return false;
+            }
+
+            if (view.itemsize != 1 || (view.format != nullptr && std::strcmp(view.format, "B") != 0))
+            {
+                PyErr_SetString(PyExc_TypeError, "frames have to be arrays of uint8");
+                return false;
+            }
+
+            if (view.ndim != 3 && view.ndim != 4)
+            {
+                PyErr_SetString(PyExc_ValueError, "frames have to be HxWxC arrays or NxHxWxC batches of them");
+                return false;
+            }
+
+            const auto* shape = view.shape + view.ndim - 3;
+            const auto* strides = view.strides + view.ndim - 3;
+            const auto height = shape[0];
+            const auto width = shape[1];
+            const auto channels = shape[2];
+
+            if (channels != 3 && channels != 4)
+            {
+                PyErr_SetString(PyExc_ValueError, "frames have to consist of either 3 or 4 channels");
+                return false;
+            }
+
+            // only rows may be padded, e.g. when a frame is cropped out of a bigger one
+            const auto frame_stride = view.ndim == 4 ? view.strides[0] : 0;
+            if (strides[2] != 1 || strides[1] != channels || strides[0] < width * channels || frame_stride < 0)
+            {
+                PyErr_SetString(PyExc_ValueError, "pixels of frames have to be contiguous, use numpy.ascontiguousarray");
+                return false;
+            }
+
+            constexpr auto MAXIMUM_DIMENSION = Py_ssize_t{std::numeric_limits<uint32_t>::max()};
+            if (width > MAXIMUM_DIMENSION || height > MAXIMUM_DIMENSION)
+            {
+                PyErr_SetString(PyExc_ValueError, "frames are too big");
+                return false;
+            }
+
+            md::FrameView frame{};
+            frame.width = static_cast<uint32_t>(width);
+            frame.height = static_cast<uint32_t>(height);
+            frame.stride = static_cast<std::size_t>(strides[0]);
+            if (channels == 3)
+            {
+                frame.format = is_bgr ? MD_PIXEL_FORMAT_BGR24 : MD_PIXEL_FORMAT_RGB24;
+            }
+            else
+            {
+                frame.format = is_bgr ? MD_PIXEL_FORMAT_BGRA32 : MD_PIXEL_FORMAT_RGBA32;
+            }
+
+            const auto frame_count = view.ndim == 4 ? view.shape[0] : 1;
+            for (Py_ssize_t i = 0; i < frame_count; i++)
+            {
+                frame.data = static_cast<const uint8_t*>(view.buf) + i * frame_stride;
+                m_frames.push_back(frame);
+            }
+
+            return true;
+        }
+
+        const std::vector<md::FrameView>& getFrames() const
+        {
+            return m_frames;
+        }
+
+    private:
+        std::deque<Py_buffer> m_views;
+        std::vector<md::FrameView> m_frames;
+    };
+
+    int initDecomposer(PyObject* self, PyObject* args, PyObject* kwargs)
+    {
+        static const char* keywords[] = {"pixel_match", "line_match", "color_match", "skip_front_lines", "skip_back_lines",
+            "skip_duplicates", "coarse_stride", "early_exit", "recursion", "threads", nullptr};
+
+        auto config = md::defaultConfig();
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$ddIIIIIIII", const_cast<char**>(keywords),
+            &config.pixel_match_ratio, &config.line_match_ratio, &config.color_match_diff,
+            &config.skip_front_lines, &config.skip_back_lines, &config.duplicate_frame_diff,
+            &config.coarse_line_stride, &config.early_exit_block, &config.recursion_depth, &config.threads))
+        {
+            return -1;
+        }
+
+        auto* decomposer = reinterpret_cast<DecomposerObject*>(self);
+        if (decomposer->m_is_busy)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "decomposer is in use");
+            return -1;
+        }
+
+        try
+        {
+            delete decomposer->m_decomposer;
+            decomposer->m_decomposer = nullptr;
+            decomposer->m_decomposer = new md::Decomposer(config);
+        }
+        catch (const std::exception& exception)
+        {
+            PyErr_SetString(PyExc_ValueError, exception.what());
+            return -1;
+        }
+
+        return 0;
+    }
+
+    void deallocDecomposer(PyObject* self)
+    {
+        delete reinterpret_cast<DecomposerObject*>(self)->m_decomposer;
+
+        // instances of heap types hold a reference of their type
+        auto* type = Py_TYPE(self);
+        type->tp_free(self);
+        Py_DECREF(type);
+    }
+
+    PyObject* decompose(PyObject* self, PyObject* args, PyObject* kwargs)
+    {
+        static const char* keywords[] = {"frames", "bgr", nullptr};
+
+        PyObject* frames_object = nullptr;
+        int is_bgr = 0;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|$p", const_cast<char**>(keywords), &frames_object, &is_bgr))
+        {
+            return nullptr;
+        }
+
+        auto* decomposer = reinterpret_cast<DecomposerObject*>(self);
+        if (decomposer->m_decomposer == nullptr || decomposer->m_is_busy)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "decomposer is either not initialized or in use by another thread");
+            return nullptr;
+        }
+
+        ExportedFrames frames;
+        if (PyObject_CheckBuffer(frames_object))
+        {
+            if (!frames.add(frames_object, is_bgr != 0))
+            {
+                return nullptr;
+            }
+        }
+        else
+        {
+            PyObject* sequence = PySequence_Fast(frames_object, "frames have to be an array or a sequence of arrays");
+            if (sequence == nullptr)
+            {
+                return nullptr;
+            }
+
+            bool is_added = true;
+            for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(sequence) && is_added; i++)
+            {
+                is_added = frames.add(PySequence_Fast_GET_ITEM(sequence, i), is_bgr != 0);
+            }
+
+            Py_DECREF(sequence);
+            if (!is_added)
+            {
+                return nullptr;
+            }
+        }
+
+        if (frames.getFrames().empty())
+        {
+            PyErr_SetString(PyExc_ValueError, "there are no frames to decompose");
+            return nullptr;
+        }
+
+        std::vector<md::Mosaic> mosaics;
+        md_status status = MD_FAILURE;
+
+        decomposer->m_is_busy = true;
+        Py_BEGIN_ALLOW_THREADS
+        status = decomposer->m_decomposer->decompose(frames.getFrames(), mosaics);
+        Py_END_ALLOW_THREADS
+        decomposer->m_is_busy = false;
+
+        if (status != MD_OK)
+        {
+            PyErr_SetString(status == MD_FAILURE ? PyExc_RuntimeError : PyExc_ValueError, md_get_status_description(status));
+            return nullptr;
+        }
+
+        PyObject* result = PyList_New(static_cast<Py_ssize_t>(mosaics.size()));
+        for (std::size_t i = 0; i < mosaics.size() && result != nullptr; i++)
+        {
+            const auto& mosaic = mosaics[i];
+            PyObject* item = Py_BuildValue("(IIII)", mosaic.x, mosaic.y, mosaic.width, mosaic.height);
+            if (item == nullptr)
+            {
+                Py_CLEAR(result);
+                break;
+            }
+
+            PyList_SET_ITEM(result, static_cast<Py_ssize_t>(i), item);
+        }
+
+        return result;
+    }
+
+    PyMethodDef DECOMPOSER_METHODS[] = {
+        {"decompose", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(&decompose)), METH_VARARGS | METH_KEYWORDS,
+            "decompose(frames, *, bgr=False)\n--\n\n"
+            "Decomposes frames into mosaics, frames are either a HxWxC uint8 array (C is 3 or 4), a NxHxWxC batch or "
+            "a sequence of such arrays. They are not copied and the GIL is released during the analysis.\n"
+            "Returns list of (x, y, width, height) tuples."},
+        {nullptr, nullptr, 0, nullptr}
+    };
+
+    template <class Function>
+    void* toSlot(Function function)
+    {
+        return reinterpret_cast<void*>(function);
+    }
+
+    PyType_Slot DECOMPOSER_SLOTS[] = {
+        {Py_tp_doc, const_cast<char*>("Decomposer(*, pixel_match=1.5, line_match=1.8, color_match=80, skip_front_lines=5, "
+            "skip_back_lines=5, skip_duplicates=0, coarse_stride=1, early_exit=0, recursion=0, threads=1)\n--\n\n"
+            "Decomposes frames into mosaics, memory used for the analysis is reused by subsequent calls.")},
+        {Py_tp_new, toSlot(&PyType_GenericNew)},
+        {Py_tp_init, toSlot(&initDecomposer)},
+        {Py_tp_dealloc, toSlot(&deallocDecomposer)},
+        {Py_tp_methods, DECOMPOSER_METHODS},
+        {0, nullptr}
+    };
+
+    PyType_Spec DECOMPOSER_SPEC = {
+        "mosaicdecomposer.Decomposer",
+        static_cast<int>(sizeof(DecomposerObject)),
+        0,
+        Py_TPFLAGS_DEFAULT,
+        DECOMPOSER_SLOTS
+    };
+
+    // type is created once the module is imported
+    PyObject* decomposer_type = nullptr;
+
+    PyObject* decomposeOnce(PyObject*, PyObject* args, PyObject* kwargs)
+    {
+        // frames are the only positional argument, keywords are split between the config and the call
+        PyObject* frames_object = nullptr;
+        if (!PyArg_ParseTuple(args, "O", &frames_object))
+        {
+            return nullptr;
+        }
+
+        PyObject* call_kwargs = PyDict_New();
+        PyObject* config_kwargs = kwargs != nullptr ? PyDict_Copy(kwargs) : PyDict_New();
+        PyObject* empty_args = PyTuple_New(0);
+        PyObject* call_args = Py_BuildValue("(O)", frames_object);
+        PyObject* decomposer = nullptr;
+        PyObject* result = nullptr;
+
+        if (call_kwargs != nullptr && config_kwargs != nullptr && empty_args != nullptr && call_args != nullptr)
+        {
+            PyObject* is_bgr = PyDict_GetItemString(config_kwargs, "bgr");
+            if (is_bgr == nullptr || (PyDict_SetItemString(call_kwargs, "bgr", is_bgr) == 0 &&
+                PyDict_DelItemString(config_kwargs, "bgr") == 0))
+            {
+                decomposer = PyObject_Call(decomposer_type, empty_args, config_kwargs);
+            }
+        }
+
+        if (decomposer != nullptr)
+        {
+            result = decompose(decomposer, call_args, call_kwargs);
+        }
+
+        Py_XDECREF(decomposer);
+        Py_XDECREF(call_args);
+        Py_XDECREF(empty_args);
+        Py_XDECREF(config_kwargs);
+        Py_XDECREF(call_kwargs);
+        return result;
+    }
+
+    PyObject* setLogLevel(PyObject*, PyObject* args)
+    {
+        static constexpr std::pair<const char*, md_log_level> LEVELS[] = {
+            {"debug", MD_LOG_LEVEL_DEBUG}, {"info", MD_LOG_LEVEL_INFO}, {"warn", MD_LOG_LEVEL_WARN},
+            {"error", MD_LOG_LEVEL_ERROR}, {"off", MD_LOG_LEVEL_OFF}};
+
+        const char* name = nullptr;
+        if (!PyArg_ParseTuple(args, "s", &name))
+        {
+            return nullptr;
+        }
+
+        for (const auto& [level_name, level] : LEVELS)
+        {
+            if (std::strcmp(name, level_name) == 0)
+            {
+                md_set_log_level(level);
+                Py_RETURN_NONE;
+            }
+        }
+
+        PyErr_SetString(PyExc_ValueError, "log level has to be one of debug, info, warn, error, off");
+        return nullptr;
+    }
+
+    PyMethodDef MODULE_METHODS[] = {
+        {"decompose", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(&decomposeOnce)), METH_VARARGS | METH_KEYWORDS,
+            "decompose(frames, *, bgr=False, **config)\n--\n\n"
+            "Decomposes frames using a temporary Decomposer created with the given config."},
+        {"set_log_level", &setLogLevel, METH_VARARGS,
+            "set_log_level(level)\n--\n\n"
+            "Sets level of messages logged to the standard output by all decomposers, one of debug, info, warn, "
+            "error, off. Only warnings and errors are logged by default."},
+        {nullptr, nullptr, 0, nullptr}
+    };
+
+    PyModuleDef MODULE = {
+        PyModuleDef_HEAD_INIT,
+        "mosaicdecomposer",
+        "Native bindings of the mosaic decomposer.",
+        -1,
+        MODULE_METHODS,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr
+    };
+}
+
+PyMODINIT_FUNC PyInit_mosaicdecomposer(void)
+{
+    decomposer_type = PyType_FromSpec(&DECOMPOSER_SPEC);
+    if (decomposer_type == nullptr)
+    {
+        return nullptr;
+    }
+
+    PyObject* module = PyModule_Create(&MODULE);
+    if (module == nullptr)
+    {
+        return nullptr;
+    }
+
+    Py_INCREF(decomposer_type);
+    if (PyModule_AddObject(module, "Decomposer", decomposer_type) < 0)
+    {
+        Py_DECREF(decomposer_type);
+        Py_DECREF(module);
+        return nullptr;
+    }
+
+    return module;
+}
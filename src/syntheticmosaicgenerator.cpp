@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+#include "syntheticmosaicgenerator.h"
+
+namespace
+{
+    // base colors of mosaics, any two of them differ substantially
+    constexpr std::array<std::array<int, 3>, 8> PALETTE{{
+        {30, 30, 30},
+        {220, 60, 60},
+        {60, 200, 80},
+        {70, 80, 220},
+        {230, 210, 60},
+        {200, 70, 210},
+        {60, 210, 210},
+        {240, 240, 240}
+    }};
+
+    constexpr Frame::DimensionsType COMPRESSION_BLOCK_SIZE = 8;
+
+    Pixel::Color clampColor(int value)
+    {
+        return static_cast<Pixel::Color>(std::clamp(value, 0, 255));
+    }
+
+    Frame::DimensionsType sum(const std::vector<Frame::DimensionsType>& sizes)
+    {
+        return static_cast<Frame::DimensionsType>(std::accumulate(sizes.begin(), sizes.end(), 0u));
+    }
+
+    std::vector<Frame::DimensionsType> splitEvenly(Frame::DimensionsType length, Frame::DimensionsType parts)
+    {
+        std::vector<Frame::DimensionsType> sizes;
+        for (unsigned i = 0; i < parts; i++)
+        {
+            sizes.push_back(static_cast<Frame::DimensionsType>(length * (i + 1) / parts - length * i / parts));
+        }
+        return sizes;
+    }
+}
+
+SyntheticMosaicParams SyntheticMosaicParams::uniformGrid(DimensionsType width, DimensionsType height,
+    DimensionsType columns, DimensionsType rows)
+{
+    SyntheticMosaicParams params;
+    params.m_column_widths = splitEvenly(width, columns);
+    params.m_row_heights = splitEvenly(height, rows);
+    return params;
+}
+
+SyntheticMosaicGenerator::SyntheticMosaicGenerator(const SyntheticMosaicParams& params) :
+    FrameProviderInterface(),
+    m_params(params),
+    m_width(sum(params.m_column_widths)),
+    m_height(sum(params.m_row_heights)),
+    m_random(params.m_seed)
+{
+}
+
+bool SyntheticMosaicGenerator::isReady() const
+{
+    return m_width > 0 && m_height > 0;
+}
+
+std::size_t SyntheticMosaicGenerator::fill(std::vector<Frame>& frames, std::size_t max_frames)
+{
+    if (!isReady())
+    {
+        return 0;
+    }
+
+    std::size_t filled_frames = 0;
+    while (filled_frames < max_frames && m_generated_frames < m_params.m_frame_count)
+    {
+        render(prepareFrame(frames, filled_frames, m_width, m_height));
+
+        m_generated_frames++;
+        filled_frames++;
+    }
+
+    return filled_frames;
+}
+
+void SyntheticMosaicGenerator::render(Frame& frame)
+{
+    const auto& column_borders = createBorders(m_params.m_column_widths);
+    const auto& row_borders = createBorders(m_params.m_row_heights);
+
+    for (std::size_t column = 0; column + 1 < column_borders.size(); column++)
+    {
+        for (std::size_t row = 0; row + 1 < row_borders.size(); row++)
+        {
+            const auto tile = column + row * 3 + m_params.m_seed;
+            const auto tile_width = static_cast<Frame::DimensionsType>(column_borders[column + 1] - column_borders[column]);
+            const auto tile_height = static_cast<Frame::DimensionsType>(row_borders[row + 1] - row_borders[row]);
+
+            for (Frame::DimensionsType x = 0; x < tile_width; x++)
+            {
+                for (Frame::DimensionsType y = 0; y < tile_height; y++)
+                {
+                    frame.set(static_cast<Frame::DimensionsType>(column_borders[column] + x),
+                        static_cast<Frame::DimensionsType>(row_borders[row] + y),
+                        renderPixel(tile, x, y, tile_width, tile_height));
+                }
+            }
+        }
+    }
+
+    if (m_params.m_blend_borders)
+    {
+        blendBorders(frame, column_borders, row_borders);
+    }
+
+    if (m_params.m_compression > 0)
+    {
+        compress(frame);
+    }
+
+    if (m_params.m_noise > 0)
+    {
+        addNoise(frame);
+    }
+}
+
+layout::Layout SyntheticMosaicGenerator::getLayout() const
+{
+    layout::Layout mosaics;
+
+    Frame::DimensionsType y = 0;
+    for (const auto height : m_params.m_row_heights)
+    {
+        Frame::DimensionsType x = 0;
+        for (const auto width : m_params.m_column_widths)
+        {
+            mosaics.push_back(MosaicDecomposer::SplitDimensions{x, y, width, height});
+            x = static_cast<Frame::DimensionsType>(x + width);
+        }
+        y = static_cast<Frame::DimensionsType>(y + height);
+    }
+
+    return mosaics;
+}
+
+std::vector<Frame::DimensionsType> SyntheticMosaicGenerator::createBorders(const std::vector<Frame::DimensionsType>& sizes)
+{
+    std::vector<Frame::DimensionsType> borders{0};
+
+    const auto jitter = static_cast<int>(m_params.m_border_jitter);
+    std::uniform_int_distribution<int> distribution(-jitter, jitter);
+
+    int nominal_border = 0;
+    for (std::size_t i = 0; i < sizes.size(); i++)
+    {
+        nominal_border += sizes[i];
+
+        if (i + 1 == sizes.size())
+        {
+            borders.push_back(static_cast<Frame::DimensionsType>(nominal_border));
+            break;
+        }
+
+        // borders have to stay ordered, otherwise mosaics would vanish
+        const auto border = std::clamp(nominal_border + distribution(m_random), borders.back() + 1,
+            nominal_border + sizes[i + 1] - 1);
+        borders.push_back(static_cast<Frame::DimensionsType>(border));
+    }
+
+    return borders;
+}
+
+Pixel SyntheticMosaicGenerator::renderPixel(std::size_t tile, Frame::DimensionsType local_x, Frame::DimensionsType local_y,
+    Frame::DimensionsType tile_width, Frame::DimensionsType tile_height) const
+{
+    const auto& base = PALETTE[tile % PALETTE.size()];
+
+    // mild gradient across the mosaic
+    auto red = base[0] + 30 * local_x / tile_width - 15;
+    auto green = base[1] + 30 * local_y / tile_height - 15;
+    auto blue = base[2];
+
+    // object moving through the mosaic, so that there are some edges inside of it as well
+    const auto object_width = std::max(1, tile_width / 4);
+    const auto object_height = std::max(1, tile_height / 4);
+    const auto object_x = static_cast<int>((m_generated_frames * 3 + tile * 17) % tile_width);
+    const auto object_y = static_cast<int>((m_generated_frames * 2 + tile * 11) % tile_height);
+
+    if (local_x >= object_x && local_x < object_x + object_width && local_y >= object_y && local_y < object_y + object_height)
+    {
+        red = 255 - red;
+        green = 255 - green;
+        blue = 255 - blue;
+    }
+
+    return Pixel{clampColor(red), clampColor(green), clampColor(blue)};
+}
+
+void SyntheticMosaicGenerator::blendBorders(Frame& frame, const std::vector<Frame::DimensionsType>& column_borders,
+    const std::vector<Frame::DimensionsType>& row_borders) const
+{
+    const auto blend = [](const Pixel& first, const Pixel& second)
+    {
+        return Pixel{static_cast<Pixel::Color>((first.m_red + second.m_red) / 2),
+            static_cast<Pixel::Color>((first.m_green + second.m_green) / 2),
+            static_cast<Pixel::Color>((first.m_blue + second.m_blue) / 2)};
+    };
+
+    for (std::size_t i = 1; i + 1 < column_borders.size(); i++)
+    {
+        const auto x = column_borders[i];
+        for (Frame::DimensionsType y = 0; y < m_height; y++)
+        {
+            frame.set(x, y, blend(frame.get(static_cast<Frame::DimensionsType>(x - 1), y), frame.get(x, y)));
+        }
+    }
+
+    for (std::size_t i = 1; i + 1 < row_borders.size(); i++)
+    {
+        const auto y = row_borders[i];
+        for (Frame::DimensionsType x = 0; x < m_width; x++)
+        {
+            frame.set(x, y, blend(frame.get(x, static_cast<Frame::DimensionsType>(y - 1)), frame.get(x, y)));
+        }
+    }
+}
+
+void SyntheticMosaicGenerator::compress(Frame& frame) const
+{
+    const int strength = std::min<int>(m_params.m_compression, 100);
+    const int quantization_step = 1 + strength / 8;
+
+    for (Frame::DimensionsType block_x = 0; block_x < m_width; block_x += COMPRESSION_BLOCK_SIZE)
+    {
+        for (Frame::DimensionsType block_y = 0; block_y < m_height; block_y += COMPRESSION_BLOCK_SIZE)
+        {
+            const auto end_x = std::min<int>(block_x + COMPRESSION_BLOCK_SIZE, m_width);
+            const auto end_y = std::min<int>(block_y + COMPRESSION_BLOCK_SIZE, m_height);
+
+            std::array<int, 3> mean{};
+            for (auto x = block_x; x < end_x; x++)
+            {
+                for (auto y = block_y; y < end_y; y++)
+                {
+                    const auto& pixel = frame.get(x, y);
+                    mean[0] += pixel.m_red;
+                    mean[1] += pixel.m_green;
+                    mean[2] += pixel.m_blue;
+                }
+            }
+
+            const auto block_size = (end_x - block_x) * (end_y - block_y);
+            for (auto& channel : mean)
+            {
+                channel /= block_size;
+            }
+
+            const auto compress_channel = [&](int value, int channel_mean)
+            {
+                value += (channel_mean - value) * strength / 100;
+                return clampColor(value / quantization_step * quantization_step);
+            };
+
+            for (auto x = block_x; x < end_x; x++)
+            {
+                for (auto y = block_y; y < end_y; y++)
+                {
+                    const auto& pixel = frame.get(x, y);
+                    frame.set(x, y, Pixel{compress_channel(pixel.m_red, mean[0]),
+                        compress_channel(pixel.m_green, mean[1]),
+                        compress_channel(pixel.m_blue, mean[2])});
+                }
+            }
+        }
+    }
+}
+
+void SyntheticMosaicGenerator::addNoise(Frame& frame)
+{
+    const auto noise = static_cast<int>(m_params.m_noise);
+    std::uniform_int_distribution<int> distribution(-noise, noise);
+
+    for (Frame::DimensionsType x = 0; x < m_width; x++)
+    {
+        for (Frame::DimensionsType y = 0; y < m_height; y++)
+        {
+            const auto& pixel = frame.get(x, y);
+            frame.set(x, y, Pixel{clampColor(pixel.m_red + distribution(m_random)),
+                clampColor(pixel.m_green + distribution(m_random)),
+                clampColor(pixel.m_blue + distribution(m_random))});
+        }
+    }
+}
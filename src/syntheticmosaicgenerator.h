@@ -0,0 +1,75 @@
+#pragma once
+
+#include <random>
+#include <vector>
+#include <cstdint>
+
+#include "frame.h"
+#include "frameproviderinterface.h"
+#include "layout.h"
+
+struct SyntheticMosaicParams
+{
+    using DimensionsType = common::DimensionsType;
+
+    //! @brief Widths of mosaic columns, frame width is the sum of them.
+    std::vector<DimensionsType> m_column_widths{160, 160};
+
+    //! @brief Heights of mosaic rows, frame height is the sum of them.
+    std::vector<DimensionsType> m_row_heights{120, 120};
+
+    uint32_t m_frame_count = 1;
+
+    //! @brief Maximum deviation of each color channel caused by random noise.
+    uint8_t m_noise = 0;
+
+    //! @brief Strength of simulated block compression artifacts in range [0, 100], 0 disables them.
+    //! Pixels of 8x8 blocks are pulled towards the block's mean color and colors are quantized.
+    uint8_t m_compression = 0;
+
+    //! @brief Maximum shift of each mosaic border, borders are randomly moved on every frame.
+    DimensionsType m_border_jitter = 0;
+
+    //! @brief Defines whether pixels on the borders are blended with the adjacent mosaic, as if scaled imprecisely.
+    bool m_blend_borders = false;
+
+    uint32_t m_seed = 0;
+
+    //! @brief Creates parameters of a grid with mosaics of (nearly) equal size.
+    static SyntheticMosaicParams uniformGrid(DimensionsType width, DimensionsType height,
+        DimensionsType columns, DimensionsType rows);
+};
+
+/**
+ * @brief Generates frames of mosaics with a known layout. Every mosaic has a distinct base color,
+ * a gradient and a moving object, so that lines inside of mosaics are not trivially matching.
+ */
+class SyntheticMosaicGenerator: public FrameProviderInterface
+{
+public:
+    explicit SyntheticMosaicGenerator(const SyntheticMosaicParams& params);
+    ~SyntheticMosaicGenerator() = default;
+
+    bool isReady() const override;
+    std::size_t fill(std::vector<Frame>& frames, std::size_t max_frames) override;
+
+    //! @brief Layout of mosaics without border jitter, i.e. ground truth of the generated frames.
+    layout::Layout getLayout() const;
+
+private:
+    void render(Frame& frame);
+    std::vector<Frame::DimensionsType> createBorders(const std::vector<Frame::DimensionsType>& sizes);
+    Pixel renderPixel(std::size_t tile, Frame::DimensionsType local_x, Frame::DimensionsType local_y,
+        Frame::DimensionsType tile_width, Frame::DimensionsType tile_height) const;
+
+    void blendBorders(Frame& frame, const std::vector<Frame::DimensionsType>& column_borders,
+        const std::vector<Frame::DimensionsType>& row_borders) const;
+    void compress(Frame& frame) const;
+    void addNoise(Frame& frame);
+
+    const SyntheticMosaicParams m_params;
+    const Frame::DimensionsType m_width;
+    const Frame::DimensionsType m_height;
+    uint32_t m_generated_frames = 0;
+    std::mt19937 m_random;
+};
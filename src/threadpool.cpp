@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <exception>
+
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(std::size_t thread_count)
+{
+    if (thread_count == 0)
+    {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // calling thread participates in execution, so one thread less is needed
+    for (std::size_t i = 1; i < thread_count; i++)
+    {
+        m_threads.emplace_back(&ThreadPool::run, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_condition.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+std::size_t ThreadPool::getThreadCount() const
+{
+    return m_threads.size() + 1;
+}
+
+bool ThreadPool::pinThreads(const topology::CpuList& cpus)
+{
+    if (cpus.empty())
+    {
+        return false;
+    }
+
+    auto is_pinned = topology::pinCurrentThread({cpus.front()});
+    for (std::size_t i = 0; i < m_threads.size(); i++)
+    {
+        is_pinned = topology::pinThread(m_threads[i], {cpus[(i + 1) % cpus.size()]}) && is_pinned;
+    }
+
+    return is_pinned;
+}
+
+void ThreadPool::parallelFor(std::size_t task_count, const std::function<void(std::size_t)>& task)
+{
+    if (m_threads.empty() || task_count < 2)
+    {
+        for (std::size_t i = 0; i < task_count; i++)
+        {
+            task(i);
+        }
+        return;
+    }
+
+    std::mutex done_mutex;
+    std::condition_variable done_condition;
+    std::size_t pending_tasks = task_count;
+    std::exception_ptr exception;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::size_t i = 0; i < task_count; i++)
+        {
+            m_tasks.push([&, i]()
+            {
+                try
+                {
+                    task(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> done_lock(done_mutex);
+                    if (!exception)
+                    {
+                        exception = std::current_exception();
+                    }
+                }
+
+                std::lock_guard<std::mutex> done_lock(done_mutex);
+                if (--pending_tasks == 0)
+                {
+                    done_condition.notify_all();
+                }
+            });
+        }
+    }
+
+    m_condition.notify_all();
+
+    // help with the execution instead of just waiting, tasks of nested calls are executed this way as well
+    while (runPendingTask())
+    {
+    }
+
+    std::unique_lock<std::mutex> done_lock(done_mutex);
+    done_condition.wait(done_lock, [&pending_tasks]() { return pending_tasks == 0; });
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+void ThreadPool::run()
+{
+    while (true)
+    {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+
+            if (m_tasks.empty())
+            {
+                return;
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+
+        task();
+    }
+}
+
+bool ThreadPool::runPendingTask()
+{
+    std::function<void()> task;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_tasks.empty())
+        {
+            return false;
+        }
+
+        task = std::move(m_tasks.front());
+        m_tasks.pop();
+    }
+
+    task();
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "topology.h"
+
+/*!
+ * @brief Maintains fixed amount of worker threads which execute submitted tasks.
+ */
+class ThreadPool
+{
+public:
+    //! @brief Creates pool of given amount of threads, 0 means amount of hardware threads.
+    explicit ThreadPool(std::size_t thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t getThreadCount() const;
+
+    //! @brief Pins each thread of the pool to a single cpu of the list in round robin order, the calling thread
+    //! (which participates in execution) to the first one.
+    bool pinThreads(const topology::CpuList& cpus);
+
+    //! @brief Executes task for each index in range [0, task_count) and blocks until all of them are finished.
+    //! @note calling thread participates in execution, so it is safe to call it from within a pool's task.
+    //! The first exception thrown by any of the tasks is rethrown after all of them are finished.
+    void parallelFor(std::size_t task_count, const std::function<void(std::size_t)>& task);
+
+private:
+    void run();
+    bool runPendingTask();
+
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping = false;
+};
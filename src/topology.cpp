@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
+#include "topology.h"
+
+namespace
+{
+    constexpr auto NODE_DIRECTORY = "/sys/devices/system/node/";
+
+    std::optional<topology::CpuList> readCpuList(const std::string& file_path)
+    {
+        std::ifstream file(file_path);
+        std::string list;
+
+        if (!std::getline(file, list))
+        {
+            return {};
+        }
+
+        return topology::parseCpuList(list);
+    }
+
+    std::optional<uint32_t> parseCpu(const std::string& text)
+    {
+        if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return {};
+        }
+
+        return static_cast<uint32_t>(std::stoul(text));
+    }
+
+    // cpus the process may run on, they may be restricted e.g. by cgroup cpuset of a container
+    topology::CpuList getAllowedCpus()
+    {
+        topology::CpuList cpus;
+
+#ifdef __linux__
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+
+        if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0)
+        {
+            for (uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            {
+                if (CPU_ISSET(cpu, &cpu_set))
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+
+            return cpus;
+        }
+#endif
+
+        for (uint32_t cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+
+        return cpus;
+    }
+
+#ifdef __linux__
+    bool pin(pthread_t thread, const topology::CpuList& cpus)
+    {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+
+        for (const auto cpu : cpus)
+        {
+            if (cpu < CPU_SETSIZE)
+            {
+                CPU_SET(cpu, &cpu_set);
+            }
+        }
+
+        const auto result = pthread_setaffinity_np(thread, sizeof(cpu_set), &cpu_set);
+        if (result != 0)
+        {
+            spdlog::error("failed to pin thread to cpus {}, error: {}", topology::toString(cpus), result);
+            return false;
+        }
+
+        return true;
+    }
+#endif
+}
+
+std::vector<topology::Node> topology::detectNodes()
+{
+    std::vector<Node> nodes;
+    const auto& allowed_cpus = getAllowedCpus();
+
+    const auto& node_ids = readCpuList(std::string(NODE_DIRECTORY) + "online");
+    for (const auto node_id : node_ids.value_or(CpuList{}))
+    {
+        const auto& cpus = readCpuList(std::string(NODE_DIRECTORY) + "node" + std::to_string(node_id) + "/cpulist");
+        if (!cpus)
+        {
+            continue;
+        }
+
+        // both lists are sorted, as they are listed in ascending order
+        Node node{node_id, {}};
+        std::set_intersection(cpus->begin(), cpus->end(), allowed_cpus.begin(), allowed_cpus.end(),
+            std::back_inserter(node.m_cpus));
+
+        // nodes of memory only or of cpus which the process may not use are left out
+        if (!node.m_cpus.empty())
+        {
+            nodes.push_back(node);
+        }
+    }
+
+    if (nodes.empty())
+    {
+        nodes.push_back(Node{0, allowed_cpus});
+    }
+
+    return nodes;
+}
+
+std::optional<topology::CpuList> topology::parseCpuList(const std::string& list)
+{
+    CpuList cpus;
+
+    std::istringstream stream(list);
+    std::string range;
+
+    while (std::getline(stream, range, ','))
+    {
+        range.erase(std::remove_if(range.begin(), range.end(), [](char c) { return c == '\n' || c == ' '; }),
+            range.end());
+
+        if (range.empty())
+        {
+            continue;
+        }
+
+        const auto separator = range.find('-');
+        const auto first = parseCpu(range.substr(0, separator));
+        const auto last = separator == std::string::npos ? first : parseCpu(range.substr(separator + 1));
+
+        if (!first || !last || *first > *last)
+        {
+            spdlog::error("cpu list {} is not valid", list);
+            return {};
+        }
+
+        for (auto cpu = *first; cpu <= *last; cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+
+    return cpus;
+}
+
+std::string topology::toString(const CpuList& cpus)
+{
+    std::ostringstream stream;
+
+    for (std::size_t i = 0; i < cpus.size(); i++)
+    {
+        // consecutive cpus are written as ranges
+        auto last = i;
+        while (last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1)
+        {
+            last++;
+        }
+
+        if (stream.tellp() > 0)
+        {
+            stream << ',';
+        }
+
+        stream << cpus[i];
+        if (last > i)
+        {
+            stream << '-' << cpus[last];
+        }
+
+        i = last;
+    }
+
+    return stream.str();
+}
+
+const topology::Node& topology::getCurrentNode(const std::vector<Node>& nodes)
+{
+#ifdef __linux__
+    const auto cpu = sched_getcpu();
+
+    for (const auto& node : nodes)
+    {
+        if (cpu >= 0 && std::find(node.m_cpus.begin(), node.m_cpus.end(), static_cast<uint32_t>(cpu)) != node.m_cpus.end())
+        {
+            return node;
+        }
+    }
+#endif
+
+    return nodes.front();
+}
+
+bool topology::pinCurrentThread(const CpuList& cpus)
+{
+#ifdef __linux__
+    return pin(pthread_self(), cpus);
+#else
+    (void)cpus;
+    spdlog::warn("thread affinity is not supported on this platform");
+    return false;
+#endif
+}
+
+bool topology::pinThread(std::thread& thread, const CpuList& cpus)
+{
+#ifdef __linux__
+    return pin(thread.native_handle(), cpus);
+#else
+    (void)thread;
+    (void)cpus;
+    spdlog::warn("thread affinity is not supported on this platform");
+    return false;
+#endif
+}
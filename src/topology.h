@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*!
+ * @brief Helpers for placing threads onto NUMA nodes and cores. Memory is allocated by the thread which touches it
+ * first on the node the thread runs on, so pinning threads which decode and analyze frames of a single input to the
+ * same node keeps frames and histograms in the node local memory.
+ */
+namespace topology
+{
+    using CpuList = std::vector<uint32_t>;
+
+    struct Node
+    {
+        uint32_t m_id = 0;
+        CpuList m_cpus;
+    };
+
+    //! @brief Detects NUMA nodes out of sysfs, a single node of all cpus is assumed when it's not present.
+    //! @note only cpus which the process is allowed to run on are listed, nodes without such cpus are left out.
+    std::vector<Node> detectNodes();
+
+    //! @brief Parses list in the kernel format, e.g. "0-3,8,10-11".
+    std::optional<CpuList> parseCpuList(const std::string& list);
+
+    std::string toString(const CpuList& cpus);
+
+    //! @brief Finds node of the cpu the calling thread currently runs on, the first node when it can't be found out.
+    const Node& getCurrentNode(const std::vector<Node>& nodes);
+
+    //! @brief Restricts the calling thread to given cpus, threads created by it afterwards inherit the restriction.
+    bool pinCurrentThread(const CpuList& cpus);
+
+    bool pinThread(std::thread& thread, const CpuList& cpus);
+}
@@ -0,0 +1,246 @@
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+
+#include <spdlog/spdlog.h>
+
+#include "videoframeproviderlibav.h"
+#include "frame.h"
+
+namespace
+{
+    // av_find_best_stream() provides const decoder since libavformat 59 (FFmpeg 5.0)
+#if LIBAVFORMAT_VERSION_MAJOR < 59
+    using Decoder = AVCodec;
+#else
+    using Decoder = const AVCodec;
+#endif
+}
+
+void VideoFrameProviderLibav::LibavDeleter::operator()(AVFormatContext* format_context) const
+{
+    avformat_close_input(&format_context);
+}
+
+void VideoFrameProviderLibav::LibavDeleter::operator()(AVCodecContext* codec_context) const
+{
+    avcodec_free_context(&codec_context);
+}
+
+void VideoFrameProviderLibav::LibavDeleter::operator()(AVFrame* frame) const
+{
+    av_frame_free(&frame);
+}
+
+void VideoFrameProviderLibav::LibavDeleter::operator()(AVPacket* packet) const
+{
+    av_packet_free(&packet);
+}
+
+void VideoFrameProviderLibav::LibavDeleter::operator()(SwsContext* sws_context) const
+{
+    sws_freeContext(sws_context);
+}
+
+VideoFrameProviderLibav::VideoFrameProviderLibav(const std::string& file_path, bool keyframes_only) :
+    FrameProviderInterface(),
+    m_keyframes_only(keyframes_only)
+{
+    m_is_ready = open(file_path);
+}
+
+bool VideoFrameProviderLibav::open(const std::string& file_path)
+{
+    AVFormatContext* format_context = nullptr;
+    if (avformat_open_input(&format_context, file_path.c_str(), nullptr, nullptr) < 0)
+    {
+        spdlog::error("failed to open video file {}", file_path);
+        return false;
+    }
+    m_format_context.reset(format_context);
+
+    if (avformat_find_stream_info(m_format_context.get(), nullptr) < 0)
+    {
+        spdlog::error("failed to find stream information of {}", file_path);
+        return false;
+    }
+
+    Decoder* codec = nullptr;
+    m_stream_index = av_find_best_stream(m_format_context.get(), AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+    if (m_stream_index < 0 || codec == nullptr)
+    {
+        spdlog::error("failed to find decodable video stream in {}", file_path);
+        return false;
+    }
+
+    m_codec_context.reset(avcodec_alloc_context3(codec));
+    if (!m_codec_context || avcodec_parameters_to_context(m_codec_context.get(), 
+        m_format_context->streams[m_stream_index]->codecpar) < 0)
+    {
+        spdlog::error("failed to set up decoder of {}", file_path);
+        return false;
+    }
+
+    if (m_keyframes_only)
+    {
+        // decoder itself discards non key frames as well, e.g. when a container does not flag packets properly
+        m_codec_context->skip_frame = AVDISCARD_NONKEY;
+    }
+
+    if (avcodec_open2(m_codec_context.get(), codec, nullptr) < 0)
+    {
+        spdlog::error("failed to open decoder of {}", file_path);
+        return false;
+    }
+
+    m_frame.reset(av_frame_alloc());
+    m_packet.reset(av_packet_alloc());
+    if (!m_frame || !m_packet)
+    {
+        spdlog::error("failed to allocate decoding buffers");
+        return false;
+    }
+
+    spdlog::info("opened {} using {} decoder{}", file_path, codec->name, m_keyframes_only ? ", decoding keyframes only" : "");
+
+    return true;
+}
+
+bool VideoFrameProviderLibav::isReady() const
+{
+    return m_is_ready;
+}
+
+std::size_t VideoFrameProviderLibav::fill(std::vector<Frame>& frames, std::size_t max_frames)
+{
+    if (!isReady())
+    {
+        spdlog::warn("video read is not ready");
+        return 0;
+    }
+
+    std::size_t filled_frames = 0;
+
+    while (filled_frames < max_frames && decodeNextFrame())
+    {
+        if (m_frame->width < 1 || m_frame->height < 1)
+        {
+            spdlog::error("acquired invalid frame dimensions from a video ({}, {})", m_frame->width, m_frame->height);
+            break;
+        }
+
+        auto& frame = prepareFrame(frames, filled_frames, static_cast<Frame::DimensionsType>(m_frame->width),
+            static_cast<Frame::DimensionsType>(m_frame->height));
+
+        if (!convert(frame))
+        {
+            break;
+        }
+
+        filled_frames++;
+    }
+
+    return filled_frames;
+}
+
+bool VideoFrameProviderLibav::skip(uint32_t frame_count)
+{
+    if (!isReady())
+    {
+        spdlog::warn("video read is not ready");
+        return false;
+    }
+
+    for (uint32_t i = 0; i < frame_count; i++)
+    {
+        if (!decodeNextFrame())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool VideoFrameProviderLibav::decodeNextFrame()
+{
+    while (true)
+    {
+        const auto result = avcodec_receive_frame(m_codec_context.get(), m_frame.get());
+        if (result == 0)
+        {
+            return true;
+        }
+
+        if (result == AVERROR_EOF || (result == AVERROR(EAGAIN) && m_is_draining))
+        {
+            spdlog::info("all frames of the video were decoded");
+            return false;
+        }
+
+        if (result != AVERROR(EAGAIN))
+        {
+            spdlog::error("failed to decode video frame");
+            return false;
+        }
+
+        if (av_read_frame(m_format_context.get(), m_packet.get()) < 0)
+        {
+            // end of the file, frames buffered by the decoder are drained
+            if (avcodec_send_packet(m_codec_context.get(), nullptr) < 0)
+            {
+                spdlog::error("failed to drain the video decoder");
+                return false;
+            }
+
+            m_is_draining = true;
+            continue;
+        }
+
+        const auto is_key_packet = (m_packet->flags & AV_PKT_FLAG_KEY) != 0;
+        if (m_packet->stream_index == m_stream_index && (is_key_packet || !m_keyframes_only) &&
+            avcodec_send_packet(m_codec_context.get(), m_packet.get()) < 0)
+        {
+            spdlog::warn("failed to send packet to the decoder, skipping it");
+        }
+
+        av_packet_unref(m_packet.get());
+    }
+}
+
+bool VideoFrameProviderLibav::convert(Frame& frame)
+{
+    const auto width = m_frame->width;
+    const auto height = m_frame->height;
+
+    m_sws_context.reset(sws_getCachedContext(m_sws_context.release(), width, height, 
+        static_cast<AVPixelFormat>(m_frame->format), width, height, AV_PIX_FMT_BGR24, SWS_POINT, nullptr, nullptr, nullptr));
+    if (!m_sws_context)
+    {
+        spdlog::error("failed to set up conversion of video frames");
+        return false;
+    }
+
+    const auto line_size = width * 3;
+    m_bgr_buffer.resize(static_cast<std::size_t>(line_size) * static_cast<std::size_t>(height));
+
+    uint8_t* destination[] = {m_bgr_buffer.data(), nullptr, nullptr, nullptr};
+    const int destination_line_sizes[] = {line_size, 0, 0, 0};
+    sws_scale(m_sws_context.get(), m_frame->data, m_frame->linesize, 0, height, destination, destination_line_sizes);
+
+    // channels are stored in the same (BGR) order as by the OpenCV providers, so that all of them agree
+    for (Frame::DimensionsType row = 0; row < height; row++)
+    {
+        const auto* source_row = m_bgr_buffer.data() + static_cast<std::size_t>(row) * static_cast<std::size_t>(line_size);
+        for (Frame::DimensionsType col = 0; col < width; col++)
+        {
+            const auto* source_pixel = source_row + col * 3u;
+            frame.set(col, row, Pixel{source_pixel[0], source_pixel[1], source_pixel[2]});
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "frameproviderinterface.h"
+
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVFrame;
+struct AVPacket;
+struct SwsContext;
+
+/**
+ * @brief Provides frames of a local video file decoded directly by libav. 
+ * In keyframes only mode packets of non key frames are dropped right after demuxing, so that they are never decoded,
+ * it substantially reduces decoding cost of long GOP content as mosaic borders are as visible in keyframes as in any other.
+ */
+class VideoFrameProviderLibav: public FrameProviderInterface
+{
+public:
+    VideoFrameProviderLibav(const std::string& file_path, bool keyframes_only);
+    ~VideoFrameProviderLibav() = default;
+
+    bool isReady() const override;
+    std::size_t fill(std::vector<Frame>& frames, std::size_t max_frames) override;
+
+    //! @brief Skipped frames are decoded, as the following ones may refer to them, but they are not converted.
+    //! @note in keyframes only mode frames are counted in keyframes, as the others are never decoded.
+    bool skip(uint32_t frame_count) override;
+
+private:
+    struct LibavDeleter
+    {
+        void operator()(AVFormatContext* format_context) const;
+        void operator()(AVCodecContext* codec_context) const;
+        void operator()(AVFrame* frame) const;
+        void operator()(AVPacket* packet) const;
+        void operator()(SwsContext* sws_context) const;
+    };
+
+    bool open(const std::string& file_path);
+    bool decodeNextFrame();
+    bool convert(Frame& frame);
+
+    const bool m_keyframes_only;
+    std::unique_ptr<AVFormatContext, LibavDeleter> m_format_context;
+    std::unique_ptr<AVCodecContext, LibavDeleter> m_codec_context;
+    std::unique_ptr<AVFrame, LibavDeleter> m_frame;
+    std::unique_ptr<AVPacket, LibavDeleter> m_packet;
+    std::unique_ptr<SwsContext, LibavDeleter> m_sws_context;
+    int m_stream_index = -1;
+    bool m_is_draining = false;
+    bool m_is_ready = false;
+    // converted frame is kept between reads, so that its memory can be reused
+    std::vector<uint8_t> m_bgr_buffer;
+};
@@ -16,33 +16,39 @@ bool VideoFrameProviderOpenCv::isReady() const
     return m_video_capture.isOpened();
 }
 
-std::optional<Frame> VideoFrameProviderOpenCv::getNext() 
+std::size_t VideoFrameProviderOpenCv::fill(std::vector<Frame>& frames, std::size_t max_frames) 
 {
     if (!isReady())
     {
         spdlog::warn("video read is not ready");
-        return {};
+        return 0;
     }    
 
-    cv::Mat mat;
+    std::size_t filled_frames = 0;
 
-    if (m_video_capture.read(mat))
+    while (filled_frames < max_frames)
     {
-        if (mat.cols < 1 || mat.rows < 1)
+        if (!m_video_capture.read(m_mat))
         {
-            spdlog::error("acquired invalid material dimensions from a video ({}, {})", mat.cols, mat.rows);
-            return {};
+            spdlog::info("read from the video capture was unsuccessful, probably all of the frames were provided");
+            break;
         }
 
-        const auto cols = static_cast<Frame::DimensionsType>(mat.cols);
-        const auto rows = static_cast<Frame::DimensionsType>(mat.rows);
+        if (m_mat.cols < 1 || m_mat.rows < 1)
+        {
+            spdlog::error("acquired invalid material dimensions from a video ({}, {})", m_mat.cols, m_mat.rows);
+            break;
+        }
+
+        const auto cols = static_cast<Frame::DimensionsType>(m_mat.cols);
+        const auto rows = static_cast<Frame::DimensionsType>(m_mat.rows);
 
-        Frame frame(cols, rows);
+        auto& frame = prepareFrame(frames, filled_frames, cols, rows);
         for (Frame::DimensionsType row = 0; row < rows; row++) 
         {
             for (Frame::DimensionsType col = 0; col < cols; col++)
             {
-                const auto& src_pixel = mat.at<cv::Vec3b>(row, col);
+                const auto& src_pixel = m_mat.at<cv::Vec3b>(row, col);
 
                 Pixel dst_pixel;
                 dst_pixel.m_red = src_pixel[0];
@@ -53,11 +59,40 @@ std::optional<Frame> VideoFrameProviderOpenCv::getNext()
             }
         }
 
-        return frame;
+        filled_frames++;
+    }
+
+    return filled_frames;
+}
+
+bool VideoFrameProviderOpenCv::skip(uint32_t frame_count)
+{
+    if (!isReady())
+    {
+        spdlog::warn("video read is not ready");
+        return false;
+    }
+
+    const auto position = m_video_capture.get(cv::CAP_PROP_POS_FRAMES);
+    const auto target_position = position + frame_count;
+
+    // position reported after seeking is verified, as some backends accept it without actually seeking
+    if (m_video_capture.set(cv::CAP_PROP_POS_FRAMES, target_position) && 
+        m_video_capture.get(cv::CAP_PROP_POS_FRAMES) == target_position)
+    {
+        return true;
     }
-    else
+
+    spdlog::info("seeking in the video is not supported, skipped frames are grabbed instead");
+    m_video_capture.set(cv::CAP_PROP_POS_FRAMES, position);
+
+    for (uint32_t i = 0; i < frame_count; i++)
     {
-        spdlog::info("read from the video capture was unsuccessful, probably all of the frames were provided");
-        return {};
+        if (!m_video_capture.grab())
+        {
+            return false;
+        }
     }
+
+    return true;
 }
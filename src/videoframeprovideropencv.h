@@ -12,8 +12,13 @@ public:
     ~VideoFrameProviderOpenCv() = default;
 
     bool isReady() const override;
-    std::optional<Frame> getNext() override;
+    std::size_t fill(std::vector<Frame>& frames, std::size_t max_frames) override;
+
+    //! @brief Seeks past skipped frames when the backend supports it, otherwise they are grabbed without decoding.
+    bool skip(uint32_t frame_count) override;
 
 private:
     cv::VideoCapture m_video_capture;
+    // decoded material is kept between reads, so that its memory can be reused
+    cv::Mat m_mat;
 };
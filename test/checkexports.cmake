@@ -0,0 +1,33 @@
+# Fails when the shared library exports other than md_ symbols, i.e. when internals leak out of it.
+# Usage: cmake -DNM=<nm> -DLIBRARY=<library> -P checkexports.cmake
+
+execute_process(
+  COMMAND ${NM} -D --defined-only ${LIBRARY}
+  OUTPUT_VARIABLE symbols
+  RESULT_VARIABLE result)
+
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "symbols of ${LIBRARY} cannot be listed")
+endif()
+
+string(REPLACE "\n" ";" symbols "${symbols}")
+
+set(api_symbols 0)
+foreach (line IN LISTS symbols)
+  # lines are "<address> <type> <name>"
+  if (line MATCHES "^[0-9a-fA-F]* +[A-Za-z] +([^ ]+)$")
+    set(name ${CMAKE_MATCH_1})
+
+    if (name MATCHES "^md_")
+      math(EXPR api_symbols "${api_symbols} + 1")
+    elseif (NOT name MATCHES "^(_init|_fini|_edata|_end|__bss_start)$")
+      message(FATAL_ERROR "${LIBRARY} exports ${name}, which is not part of the C interface")
+    endif()
+  endif()
+endforeach()
+
+if (api_symbols EQUAL 0)
+  message(FATAL_ERROR "${LIBRARY} does not export the C interface")
+endif()
+
+message(STATUS "${LIBRARY} exports only ${api_symbols} symbols of the C interface")
@@ -0,0 +1,216 @@
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#include "mosaicdecomposer.h"
+#include "syntheticmosaicgenerator.h"
+
+namespace
+{
+    // throughput of each case is appended into this file, located in the working directory of the test
+    constexpr auto THROUGHPUT_REPORT = "corpus.throughput.csv";
+
+    SyntheticMosaicParams createParams(common::DimensionsType width, common::DimensionsType height,
+        common::DimensionsType columns, common::DimensionsType rows, uint32_t frames)
+    {
+        auto params = SyntheticMosaicParams::uniformGrid(width, height, columns, rows);
+        params.m_frame_count = frames;
+        return params;
+    }
+
+    Frame copyFrame(const Frame& frame)
+    {
+        Frame copy(frame.getWidth(), frame.getHeight());
+        for (Frame::DimensionsType x = 0; x < frame.getWidth(); x++)
+        {
+            for (Frame::DimensionsType y = 0; y < frame.getHeight(); y++)
+            {
+                copy.set(x, y, frame.get(x, y));
+            }
+        }
+
+        return copy;
+    }
+
+    //! @param frame_repeats amount of times each generated frame is provided, i.e. static stretches of the input.
+    void runCorpusCase(const std::string& name, const SyntheticMosaicParams& params, const ConfigParams& config = ConfigParams{},
+        uint32_t frame_repeats = 1)
+    {
+        SyntheticMosaicGenerator generator(params);
+
+        // frames are generated upfront, so that only the decomposition is measured
+        std::vector<Frame> frames;
+        while (const auto& frame = generator.getNext())
+        {
+            frames.push_back(*frame);
+
+            // repeated frames don't share memory, as a decoder provides each of them in its own buffer
+            for (uint32_t i = 1; i < frame_repeats; i++)
+            {
+                frames.push_back(copyFrame(*frame));
+            }
+        }
+
+        class PreparedFramesProvider : public FrameProviderInterface
+        {
+        public:
+            explicit PreparedFramesProvider(const std::vector<Frame>& frames) : m_frames(frames) {}
+
+            bool isReady() const override { return !m_frames.empty(); }
+
+            std::size_t fill(std::vector<Frame>& frames, std::size_t max_frames) override
+            {
+                std::size_t filled_frames = 0;
+                for (; filled_frames < max_frames && m_next_frame < m_frames.size(); filled_frames++)
+                {
+                    storeFrame(frames, filled_frames, m_frames[m_next_frame++]);
+                }
+
+                return filled_frames;
+            }
+
+        private:
+            const std::vector<Frame>& m_frames;
+            std::size_t m_next_frame = 0;
+        } frame_provider(frames);
+
+        MosaicDecomposer decomposer(frame_provider, config);
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto& dimensions = decomposer.calculateMosaicsDimensions();
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const auto fps = static_cast<double>(frames.size()) / elapsed;
+        const auto tolerance = static_cast<common::DimensionsType>(params.m_border_jitter + 2);
+        const auto score = layout::score(dimensions, generator.getLayout(), tolerance);
+
+        std::ofstream report(THROUGHPUT_REPORT, std::ios::app);
+        report << name << ',' << frames.size() << ',' << elapsed << ',' << fps << ',' << score << '\n';
+
+        INFO ("expected: " << layout::toString(generator.getLayout()));
+        INFO ("detected: " << layout::toString(dimensions));
+        INFO ("frames/sec: " << fps);
+
+        REQUIRE (score == Approx(1.));
+    }
+}
+
+TEST_CASE("Clean 2x2 image", "[corpus]")
+{
+    runCorpusCase("image-2x2", createParams(320, 240, 2, 2, 1));
+}
+
+TEST_CASE("Single mosaic image", "[corpus]")
+{
+    runCorpusCase("image-1x1", createParams(320, 240, 1, 1, 1));
+}
+
+TEST_CASE("Noisy 3x3 image", "[corpus]")
+{
+    auto params = createParams(480, 270, 3, 3, 1);
+    params.m_noise = 10;
+
+    runCorpusCase("image-3x3-noise", params);
+}
+
+TEST_CASE("Noisy 4x4 video", "[corpus]")
+{
+    auto params = createParams(640, 360, 4, 4, 20);
+    params.m_noise = 5;
+
+    runCorpusCase("video-4x4-noise", params);
+}
+
+TEST_CASE("Compressed 2x2 video", "[corpus]")
+{
+    auto params = createParams(320, 240, 2, 2, 20);
+    params.m_compression = 60;
+
+    runCorpusCase("video-2x2-compression", params);
+}
+
+TEST_CASE("Misaligned 3x2 video", "[corpus]")
+{
+    auto params = createParams(480, 270, 3, 2, 30);
+    params.m_noise = 4;
+    params.m_border_jitter = 1;
+
+    runCorpusCase("video-3x2-jitter", params);
+}
+
+TEST_CASE("Blended 2x3 video", "[corpus]")
+{
+    auto params = createParams(320, 240, 2, 3, 20);
+    params.m_noise = 4;
+    params.m_compression = 30;
+    params.m_blend_borders = true;
+
+    runCorpusCase("video-2x3-blend", params);
+}
+
+TEST_CASE("Uneven 3x2 video", "[corpus]")
+{
+    SyntheticMosaicParams params;
+    params.m_column_widths = {100, 220, 160};
+    params.m_row_heights = {90, 180};
+    params.m_frame_count = 20;
+    params.m_noise = 6;
+
+    runCorpusCase("video-3x2-uneven", params);
+}
+
+TEST_CASE("Coarse to fine noisy 4x4 video", "[corpus]")
+{
+    auto params = createParams(640, 360, 4, 4, 20);
+    params.m_noise = 5;
+
+    ConfigParams config;
+    config.m_coarse_line_stride = 8;
+
+    runCorpusCase("video-4x4-noise-coarse", params, config);
+}
+
+TEST_CASE("Coarse to fine compressed 3x3 video", "[corpus]")
+{
+    auto params = createParams(960, 540, 3, 3, 20);
+    params.m_noise = 4;
+    params.m_compression = 30;
+
+    ConfigParams config;
+    config.m_coarse_line_stride = 8;
+
+    runCorpusCase("video-3x3-compression-coarse", params, config);
+}
+
+TEST_CASE("Early exit uneven 3x2 video", "[corpus]")
+{
+    SyntheticMosaicParams params;
+    params.m_column_widths = {100, 220, 160};
+    params.m_row_heights = {90, 180};
+    params.m_frame_count = 20;
+    params.m_noise = 6;
+
+    ConfigParams config;
+    config.m_early_exit_block = 32;
+
+    runCorpusCase("video-3x2-uneven-early-exit", params, config);
+}
+
+TEST_CASE("Incremental static and noisy 3x3 video", "[corpus]")
+{
+    ConfigParams incremental_config;
+    incremental_config.m_incremental_analysis = true;
+
+    // each frame is held for several frames, so that most lines are unchanged
+    auto static_params = createParams(960, 540, 3, 3, 10);
+    runCorpusCase("video-3x3-static", static_params, ConfigParams{}, 4);
+    runCorpusCase("video-3x3-static-incremental", static_params, incremental_config, 4);
+
+    // every line changes with each frame, so counts cannot be reused
+    auto noisy_params = createParams(960, 540, 3, 3, 40);
+    noisy_params.m_noise = 5;
+    runCorpusCase("video-3x3-noise", noisy_params);
+    runCorpusCase("video-3x3-noise-incremental", noisy_params, incremental_config);
+}
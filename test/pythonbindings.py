@@ -0,0 +1,85 @@
+# checks python bindings of the decomposer, module has to be on the path (see test/CMakeLists.txt)
+import threading
+import unittest
+
+import mosaicdecomposer
+
+WIDTH = 64
+HEIGHT = 48
+SPLIT_X = 20
+SPLIT_Y = 30
+EXPECTED_LAYOUT = [(0, 0, 20, 30), (20, 0, 44, 30), (0, 30, 20, 18), (20, 30, 44, 18)]
+
+
+def create_mosaic_frame(seed, channels=3):
+    """Creates HxWxC frame of 2x2 mosaics of distinct colors with a slight noise, numpy is not required."""
+    data = bytearray(WIDTH * HEIGHT * channels)
+    for y in range(HEIGHT):
+        for x in range(WIDTH):
+            noise = (x * 7 + y * 13 + seed) % 10
+            offset = (y * WIDTH + x) * channels
+            data[offset] = (40 if x < SPLIT_X else 200) + noise
+            data[offset + 1] = 100
+            data[offset + 2] = (30 if y < SPLIT_Y else 190) + noise
+    return memoryview(data).cast('B', (HEIGHT, WIDTH, channels))
+
+
+def assert_layout(test, layout):
+    test.assertEqual(len(layout), len(EXPECTED_LAYOUT))
+    for detected, expected in zip(layout, EXPECTED_LAYOUT):
+        for detected_value, expected_value in zip(detected, expected):
+            test.assertLessEqual(abs(detected_value - expected_value), 1)
+
+
+class PythonBindingsTest(unittest.TestCase):
+    def test_sequence_of_frames(self):
+        frames = [create_mosaic_frame(seed) for seed in range(3)]
+        assert_layout(self, mosaicdecomposer.decompose(frames))
+
+    def test_batch_of_frames(self):
+        frames = b''.join(create_mosaic_frame(seed, 4).tobytes() for seed in range(3))
+        batch = memoryview(frames).cast('B', (3, HEIGHT, WIDTH, 4))
+        assert_layout(self, mosaicdecomposer.decompose(batch, bgr=True, threads=2))
+
+    def test_concurrent_decompositions(self):
+        frames = [create_mosaic_frame(seed) for seed in range(3)]
+        layouts = []
+
+        def decompose():
+            decomposer = mosaicdecomposer.Decomposer(color_match=80)
+            for _ in range(3):
+                layouts.append(decomposer.decompose(frames))
+
+        threads = [threading.Thread(target=decompose) for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        self.assertEqual(len(layouts), 12)
+        for layout in layouts:
+            assert_layout(self, layout)
+
+    def test_invalid_frames(self):
+        with self.assertRaises(ValueError):
+            mosaicdecomposer.decompose(memoryview(bytearray(WIDTH * HEIGHT * 2)).cast('B', (HEIGHT, WIDTH, 2)))
+        with self.assertRaises(ValueError):
+            mosaicdecomposer.decompose([create_mosaic_frame(0), create_mosaic_frame(0)[:SPLIT_Y]])
+        with self.assertRaises(TypeError):
+            mosaicdecomposer.decompose(42)
+
+    def test_log_level(self):
+        frames = [create_mosaic_frame(seed) for seed in range(3)]
+        mosaicdecomposer.set_log_level('off')
+        assert_layout(self, mosaicdecomposer.decompose(frames))
+        mosaicdecomposer.set_log_level('warn')
+        with self.assertRaises(ValueError):
+            mosaicdecomposer.set_log_level('verbose')
+
+    def test_invalid_config(self):
+        with self.assertRaises(ValueError):
+            mosaicdecomposer.Decomposer(recursion=1000)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -1,6 +1,221 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "decomposerapiwrapper.h"
+#include "duplicateframefilter.h"
+#include "fileprefetcher.h"
 #include "frame.h"
+#include "frameproviderinterface.h"
+#include "imageframeprovideropencv.h"
+#include "linematcher.h"
+#include "memoryframeprovider.h"
+#include "mosaicdecomposer.h"
+#include "parametersweep.h"
+#include "threadpool.h"
+#include "topology.h"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <cstdlib>
+#include <unistd.h>
+#endif
+
+#ifdef USE_SERVER
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "decompositionserver.h"
+#endif
+
+#ifdef USE_LIBAV
+#include "framewriteropencv.h"
+#include "videoframeprovideropencv.h"
+#include "videoframeproviderlibav.h"
+#endif
+
+namespace
+{
+    class FramesProvider : public FrameProviderInterface
+    {
+    public:
+        explicit FramesProvider(std::vector<Frame> frames) : m_frames(std::move(frames)) {}
+
+        bool isReady() const override { return true; }
+
+        std::size_t fill(std::vector<Frame>& frames, std::size_t max_frames) override
+        {
+            std::size_t filled_frames = 0;
+            for (; filled_frames < max_frames && m_next_frame < m_frames.size(); filled_frames++)
+            {
+                storeFrame(frames, filled_frames, m_frames[m_next_frame++]);
+            }
+
+            return filled_frames;
+        }
+
+    private:
+        std::vector<Frame> m_frames;
+        std::size_t m_next_frame = 0;
+    };
+
+    // creates frame consisting of 2x2 mosaics of distinct colors with a slight noise
+    Frame createMosaicFrame(Frame::DimensionsType split_x, Frame::DimensionsType split_y, unsigned seed)
+    {
+        Frame frame(64, 48);
+
+        for (Frame::DimensionsType x = 0; x < frame.getWidth(); x++)
+        {
+            for (Frame::DimensionsType y = 0; y < frame.getHeight(); y++)
+            {
+                const auto noise = static_cast<Pixel::Color>((x * 7u + y * 13u + seed) % 10u);
+                const auto red = static_cast<Pixel::Color>((x < split_x ? 40 : 200) + noise);
+                const auto blue = static_cast<Pixel::Color>((y < split_y ? 30 : 190) + noise);
+
+                frame.set(x, y, Pixel{red, 100, blue});
+            }
+        }
+
+        return frame;
+    }
+
+    // creates frame consisting of a big mosaic on the left and a group of 2x2 smaller mosaics on the right
+    Frame createNestedMosaicFrame(unsigned seed)
+    {
+        Frame frame(320, 128);
+
+        for (Frame::DimensionsType x = 0; x < frame.getWidth(); x++)
+        {
+            for (Frame::DimensionsType y = 0; y < frame.getHeight(); y++)
+            {
+                const auto noise = static_cast<int>((x * 7u + y * 13u + seed) % 10u);
+                const auto color = [noise](int red, int green, int blue)
+                {
+                    return Pixel{static_cast<Pixel::Color>(red + noise), static_cast<Pixel::Color>(green + noise), 
+                        static_cast<Pixel::Color>(blue + noise)};
+                };
+
+                if (x < 224)
+                {
+                    frame.set(x, y, color(40, 40, 40));
+                }
+                else if (x < 272)
+                {
+                    frame.set(x, y, y < 64 ? color(220, 60, 60) : color(60, 200, 80));
+                }
+                else
+                {
+                    frame.set(x, y, y < 64 ? color(70, 80, 220) : color(230, 210, 60));
+                }
+            }
+        }
+
+        return frame;
+    }
+
+    std::vector<Frame> createMosaicFrames(std::size_t count)
+    {
+        std::vector<Frame> frames;
+        for (unsigned i = 0; i < count; i++)
+        {
+            frames.push_back(createMosaicFrame(20, 30, i));
+        }
+        return frames;
+    }
+
+    /**
+     * @brief Unique directory for files created by a test, so that they don't end up in the working directory.
+     * Files whose paths were provided are removed along with the directory.
+     */
+    class TemporaryDirectory
+    {
+    public:
+        TemporaryDirectory()
+        {
+#ifdef _WIN32
+            const auto* base = std::getenv("TEMP");
+            std::string pattern = std::string(base != nullptr ? base : ".") + "\\mosaic_decomposer_test_XXXXXX";
+            if (_mktemp_s(pattern.data(), pattern.size() + 1) == 0 && _mkdir(pattern.c_str()) == 0)
+            {
+                m_path = pattern;
+            }
+#else
+            const auto* base = std::getenv("TMPDIR");
+            std::string pattern = std::string(base != nullptr ? base : "/tmp") + "/mosaic_decomposer_test_XXXXXX";
+            if (mkdtemp(pattern.data()) != nullptr)
+            {
+                m_path = pattern;
+            }
+#endif
+            if (m_path.empty())
+            {
+                throw std::runtime_error("temporary directory cannot be created");
+            }
+        }
+
+        ~TemporaryDirectory()
+        {
+            for (const auto& file_path : m_file_paths)
+            {
+                std::remove(file_path.c_str());
+            }
+
+#ifdef _WIN32
+            _rmdir(m_path.c_str());
+#else
+            rmdir(m_path.c_str());
+#endif
+        }
+
+        TemporaryDirectory(const TemporaryDirectory&) = delete;
+        TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+        std::string getFilePath(const std::string& file_name)
+        {
+            m_file_paths.push_back(m_path + "/" + file_name);
+            return m_file_paths.back();
+        }
+
+    private:
+        std::string m_path;
+        std::vector<std::string> m_file_paths;
+    };
+
+    // writes frame as a binary PPM image, which every OpenCV build is able to decode, red and blue are swapped
+    // as the providers keep channels in the order of OpenCV (BGR)
+    void writeImage(const std::string& file_path, const Frame& frame)
+    {
+        std::ofstream file(file_path, std::ios::binary);
+        file << "P6\n" << frame.getWidth() << ' ' << frame.getHeight() << "\n255\n";
+
+        for (Frame::DimensionsType y = 0; y < frame.getHeight(); y++)
+        {
+            for (Frame::DimensionsType x = 0; x < frame.getWidth(); x++)
+            {
+                const auto& pixel = frame.get(x, y);
+                file << pixel.m_blue << pixel.m_green << pixel.m_red;
+            }
+        }
+    }
+}
 
 TEST_CASE("Pixel operations", "Pixel")
 {
@@ -55,6 +270,226 @@ TEST_CASE("Pixel operations", "Pixel")
     } 
 }
 
+TEST_CASE("Compile time pixel comparisons", "Pixel")
+{
+    constexpr Pixel pixel{10, 20, 30};
+    constexpr Pixel other{20, 10, 35};
+
+    static_assert(pixel.colorDifference(other) == 25);
+    static_assert(pixel.coarseCompare<25>(other));
+    static_assert(!pixel.coarseCompare<24>(other));
+
+    REQUIRE (pixel.coarseCompare(other, 25) == pixel.coarseCompare<25>(other));
+}
+
+TEST_CASE("Line matching", "LineMatcher")
+{
+    Frame frame(23, 17);
+
+    unsigned seed = 7;
+    for (Frame::DimensionsType x = 0; x < frame.getWidth(); x++)
+    {
+        for (Frame::DimensionsType y = 0; y < frame.getHeight(); y++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            const auto value = static_cast<Pixel::Color>(seed >> 24);
+            frame.set(x, y, Pixel{value, static_cast<Pixel::Color>(value / 2), 100});
+        }
+    }
+
+    const auto rotated = frame.rotate90();
+
+    // specialized and generic counters shall yield the same results as comparisons of the (rotated) frame's pixels
+    for (const uint16_t deviation : {uint16_t{60}, uint16_t{80}, uint16_t{81}})
+    {
+        const auto count_horizontal = linematcher::selectMatchCounter(linematcher::Orientation::Horizontal, deviation);
+        const auto count_vertical = linematcher::selectMatchCounter(linematcher::Orientation::Vertical, deviation);
+
+        REQUIRE (linematcher::isSpecialized(deviation) == (deviation != 81));
+
+        for (Frame::DimensionsType line = 0; line + 1 < frame.getHeight(); line++)
+        {
+            Frame::DimensionsType expected = 0;
+            for (Frame::DimensionsType x = 0; x < frame.getWidth(); x++)
+            {
+                expected = static_cast<Frame::DimensionsType>(expected + 
+                    frame.get(x, line).coarseCompare(frame.get(x, static_cast<Frame::DimensionsType>(line + 1)), deviation));
+            }
+
+            REQUIRE (count_horizontal(frame, line, 0, frame.getWidth(), deviation) == expected);
+        }
+
+        for (Frame::DimensionsType line = 0; line + 1 < rotated.getHeight(); line++)
+        {
+            Frame::DimensionsType expected = 0;
+            for (Frame::DimensionsType x = 0; x < rotated.getWidth(); x++)
+            {
+                expected = static_cast<Frame::DimensionsType>(expected + 
+                    rotated.get(x, line).coarseCompare(rotated.get(x, static_cast<Frame::DimensionsType>(line + 1)), deviation));
+            }
+
+            REQUIRE (count_vertical(frame, line, 0, frame.getHeight(), deviation) == expected);
+        }
+    }
+}
+
+TEST_CASE("Incremental line matching", "LineMatcher")
+{
+    // frames differ only in a small rectangle which moves around, some of them are identical to the previous one
+    std::vector<Frame> frames;
+    for (unsigned i = 0; i < 12; i++)
+    {
+        auto frame = createMosaicFrame(20, 30, 0);
+        const auto position = static_cast<Frame::DimensionsType>(i / 2 * 7);
+        for (Frame::DimensionsType x = position; x < position + 5; x++)
+        {
+            for (Frame::DimensionsType y = position; y < position + 3; y++)
+            {
+                frame.set(x, y, Pixel{255, 255, 255});
+            }
+        }
+        frames.push_back(frame);
+    }
+
+    SECTION( "changed lines are found exactly" ) 
+    {
+        linematcher::ChangeDetector detector;
+        linematcher::ChangedLines changes;
+
+        detector.detect(frames[0], changes);
+        REQUIRE_FALSE (changes.m_is_known);
+
+        detector.detect(frames[1], changes);
+        REQUIRE (changes.m_is_known);
+        REQUIRE (std::count(changes.m_rows.begin(), changes.m_rows.end(), 1) == 0);
+        REQUIRE (std::count(changes.m_columns.begin(), changes.m_columns.end(), 1) == 0);
+
+        // the rectangle moves from [0, 5) x [0, 3) to [7, 12) x [7, 10)
+        detector.detect(frames[2], changes);
+        REQUIRE (changes.m_is_known);
+        for (Frame::DimensionsType y = 0; y < frames[2].getHeight(); y++)
+        {
+            REQUIRE (changes.m_rows[y] == ((y < 3 || (y >= 7 && y < 10)) ? 1 : 0));
+        }
+        for (Frame::DimensionsType x = 0; x < frames[2].getWidth(); x++)
+        {
+            REQUIRE (changes.m_columns[x] == ((x < 5 || (x >= 7 && x < 12)) ? 1 : 0));
+        }
+    }
+
+    SECTION( "lines are not compared once most of them keep changing" ) 
+    {
+        linematcher::ChangeDetector detector;
+        linematcher::ChangedLines changes;
+
+        // whole frame changes with each of the first frames, the rest of them are static
+        std::vector<bool> known_changes;
+        for (uint8_t i = 0; i < 40; i++)
+        {
+            const auto color = std::min<uint8_t>(i, 10);
+
+            Frame frame(20, 10);
+            for (Frame::DimensionsType x = 0; x < frame.getWidth(); x++)
+            {
+                for (Frame::DimensionsType y = 0; y < frame.getHeight(); y++)
+                {
+                    frame.set(x, y, Pixel{color, color, color});
+                }
+            }
+
+            detector.detect(frame, changes);
+            known_changes.push_back(changes.m_is_known);
+        }
+
+        REQUIRE (std::count(known_changes.begin(), known_changes.begin() + 11, true) == 0);
+        REQUIRE (known_changes.back());
+    }
+
+    SECTION( "counts are identical to the full recount" ) 
+    {
+        linematcher::ChangeDetector detector;
+        std::vector<linematcher::ChangedLines> changes(frames.size());
+        for (std::size_t i = 0; i < frames.size(); i++)
+        {
+            detector.detect(frames[i], changes[i]);
+        }
+
+        // flags of each frame are shared by both orientations
+        for (const auto orientation : {linematcher::Orientation::Horizontal, linematcher::Orientation::Vertical})
+        {
+            linematcher::LineMatcher full_matcher(orientation, 80);
+            linematcher::LineMatcher incremental_matcher(orientation, 80);
+
+            for (std::size_t i = 0; i < frames.size(); i++)
+            {
+                const auto& frame = frames[i];
+                const auto end_line = static_cast<Frame::DimensionsType>(
+                    (orientation == linematcher::Orientation::Horizontal ? frame.getHeight() : frame.getWidth()) - 3);
+
+                const auto expected = full_matcher.countMatchedPixels(frame, 2, end_line);
+                const auto& matched_pixels = incremental_matcher.countMatchedPixels(frame, 2, end_line, &changes[i]);
+
+                REQUIRE (std::equal(expected.begin() + 2, expected.begin() + end_line, matched_pixels.begin() + 2));
+            }
+
+            REQUIRE (full_matcher.getReusedLines() == 0);
+            REQUIRE (incremental_matcher.getReusedLines() > incremental_matcher.getCountedLines());
+        }
+    }
+
+    SECTION( "analysis state is identical to the full analysis" ) 
+    {
+        FramesProvider reference_provider(frames);
+        MosaicDecomposer reference_decomposer(reference_provider);
+        const auto& reference_state = reference_decomposer.analyzeFrames();
+
+        ConfigParams params;
+        params.m_incremental_analysis = true;
+        params.m_batch_size = 5;
+
+        ThreadPool thread_pool(3);
+        FramesProvider frame_provider(frames);
+        MosaicDecomposer decomposer(frame_provider, params, &thread_pool);
+        const auto& state = decomposer.analyzeFrames();
+
+        REQUIRE (state->m_horizontal.m_split_histogram == reference_state->m_horizontal.m_split_histogram);
+        REQUIRE (state->m_vertical.m_split_histogram == reference_state->m_vertical.m_split_histogram);
+        REQUIRE (state->m_horizontal.m_comparisons.getTotalAverage() == 
+            Approx(reference_state->m_horizontal.m_comparisons.getTotalAverage()));
+    }
+}
+
+TEST_CASE("Early exit line matching", "LineMatcher")
+{
+    const auto frame = createMosaicFrame(20, 30, 3);
+    const auto ratio = SampleAvgStorage::toFixedPointRatio(1.5);
+
+    for (const auto orientation : {linematcher::Orientation::Horizontal, linematcher::Orientation::Vertical})
+    {
+        const auto is_horizontal = orientation == linematcher::Orientation::Horizontal;
+        const auto line_width = is_horizontal ? frame.getWidth() : frame.getHeight();
+        const auto line_count = is_horizontal ? frame.getHeight() : frame.getWidth();
+
+        linematcher::LineMatcher matcher(orientation, 80);
+
+        // average of 90% matches
+        SampleAvgStorage average;
+        average.addSample(90, 100);
+
+        for (Frame::DimensionsType line = 0; line + 1 < line_count; line++)
+        {
+            const auto exact = matcher.countMatchedPixels(frame, line);
+            const auto estimate = matcher.estimateMatchedPixels(frame, line, 8, average, ratio);
+
+            REQUIRE (estimate <= line_width);
+            REQUIRE (average.isBelowAverage(estimate, line_width, ratio) == average.isBelowAverage(exact, line_width, ratio));
+        }
+
+        // classification of every line, including the split, is settled before its end
+        REQUIRE (matcher.getEstimatedLines() == line_count - 1u);
+    }
+}
+
 TEST_CASE("Frame operations", "Frame")
 {
     Frame frame(10, 15);
@@ -194,3 +629,1190 @@ TEST_CASE("Frame copies", "Frame")
         REQUIRE (rotated_copy.get(1, 0).m_red == 3);
     }
 }
+
+TEST_CASE("Analysis state", "AnalysisState")
+{
+    AnalysisState state;
+    state.m_width = 8;
+    state.m_height = 6;
+    state.m_processed_frames = 3;
+    state.m_horizontal.m_split_histogram = {0, 0, 3, 0, 0, 0};
+    state.m_vertical.m_split_histogram = {0, 0, 0, 2, 1, 0, 0, 0};
+
+    for (int i = 0; i < 20; i++)
+    {
+        state.m_horizontal.m_comparisons.addSample(90, 100);
+        state.m_vertical.m_comparisons.addSample(i % 2 ? 80 : 60, 100);
+    }
+
+    SECTION( "match rates are compared exactly" ) 
+    {
+        // 70 / 1.4 is not exactly 50 in floating point arithmetic
+        const auto ratio = SampleAvgStorage::toFixedPointRatio(1.4);
+        REQUIRE (ratio == 1400);
+        REQUIRE (state.m_vertical.m_comparisons.isBelowAverage(50, 100, ratio) == false);
+        REQUIRE (state.m_vertical.m_comparisons.isBelowAverage(49, 100, ratio) == true);
+        REQUIRE (state.m_vertical.m_comparisons.isBelowAverage(24, 50, ratio) == true);
+        REQUIRE (state.m_vertical.m_comparisons.isBelowAverage(25, 50, ratio) == false);
+        REQUIRE (state.m_vertical.m_comparisons.getTotalAverage() == Approx(70.));
+    }
+
+    SECTION( "saved state can be loaded back" ) 
+    {
+        TemporaryDirectory directory;
+        const auto& file_path = directory.getFilePath("analysis_state_test.bin");
+        REQUIRE (state.save(file_path));
+
+        const auto& loaded = AnalysisState::load(file_path);
+
+        REQUIRE (loaded.has_value());
+        REQUIRE (loaded->m_width == 8);
+        REQUIRE (loaded->m_height == 6);
+        REQUIRE (loaded->m_processed_frames == 3);
+        REQUIRE (loaded->m_horizontal.m_split_histogram == state.m_horizontal.m_split_histogram);
+        REQUIRE (loaded->m_vertical.m_split_histogram == state.m_vertical.m_split_histogram);
+        REQUIRE (loaded->m_horizontal.m_comparisons.getSampleCount() == 20);
+        REQUIRE (loaded->m_vertical.m_comparisons.getTotalAverage() == Approx(70.));
+    }
+
+    SECTION( "missing file cannot be loaded" ) 
+    {
+        REQUIRE (AnalysisState::load("non_existing_analysis_state.bin").has_value() == false);
+    }
+
+    SECTION( "state whose histograms don't match its dimensions cannot be loaded" ) 
+    {
+        TemporaryDirectory directory;
+        const auto& file_path = directory.getFilePath("analysis_state_test.bin");
+
+        state.m_width = 10;
+        REQUIRE (state.save(file_path));
+        REQUIRE (AnalysisState::load(file_path).has_value() == false);
+
+        // histograms are empty until the first frame is analyzed
+        state.m_horizontal.m_split_histogram.clear();
+        state.m_vertical.m_split_histogram.clear();
+        REQUIRE (state.save(file_path));
+        REQUIRE (AnalysisState::load(file_path).has_value());
+    }
+
+    SECTION( "states of time ranges can be merged" ) 
+    {
+        AnalysisState merged;
+        REQUIRE (merged.merge(state));
+        REQUIRE (merged.merge(state));
+        REQUIRE (merged.merge(AnalysisState{}));
+
+        REQUIRE (merged.m_width == 8);
+        REQUIRE (merged.m_height == 6);
+        REQUIRE (merged.m_processed_frames == 6);
+        REQUIRE (merged.m_horizontal.m_split_histogram == std::vector<common::SplitOccurenceType>{0, 0, 6, 0, 0, 0});
+        REQUIRE (merged.m_vertical.m_split_histogram == std::vector<common::SplitOccurenceType>{0, 0, 0, 4, 2, 0, 0, 0});
+        REQUIRE (merged.m_vertical.m_comparisons.getSampleCount() == 40);
+        REQUIRE (merged.m_vertical.m_comparisons.getTotalAverage() == Approx(70.));
+    }
+
+    SECTION( "states of different dimensions cannot be merged" ) 
+    {
+        AnalysisState other = state;
+        other.m_width = 10;
+
+        REQUIRE (other.merge(state) == false);
+        REQUIRE (other.m_processed_frames == 3);
+    }
+
+    SECTION( "dimensions can be calculated without frame provider" ) 
+    {
+        MosaicDecomposer decomposer(ConfigParams{});
+        const auto& dimensions = decomposer.calculateMosaicsDimensions(state);
+
+        REQUIRE (dimensions.size() == 4);
+        REQUIRE (dimensions[0].m_width == 3);
+        REQUIRE (dimensions[0].m_height == 2);
+        REQUIRE (dimensions[3].m_x == 3);
+        REQUIRE (dimensions[3].m_y == 2);
+        REQUIRE (dimensions[3].m_width == 5);
+        REQUIRE (dimensions[3].m_height == 4);
+    }
+}
+
+TEST_CASE("Thread pool", "ThreadPool")
+{
+    ThreadPool thread_pool(4);
+
+    REQUIRE (thread_pool.getThreadCount() == 4);
+
+    SECTION( "all tasks are executed" ) 
+    {
+        std::vector<int> results(100);
+        thread_pool.parallelFor(results.size(), [&results](std::size_t i) { results[i] = static_cast<int>(i) * 2; });
+
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+            REQUIRE (results[i] == static_cast<int>(i) * 2);
+        }
+    }
+
+    SECTION( "nested calls are executed" ) 
+    {
+        std::atomic<int> counter{0};
+        thread_pool.parallelFor(8, [&](std::size_t)
+        {
+            thread_pool.parallelFor(8, [&counter](std::size_t) { counter++; });
+        });
+
+        REQUIRE (counter == 64);
+    }
+
+    SECTION( "exceptions are propagated" ) 
+    {
+        REQUIRE_THROWS_AS (thread_pool.parallelFor(10, [](std::size_t i)
+        {
+            if (i == 5)
+            {
+                throw std::runtime_error("failure");
+            }
+        }), std::runtime_error);
+    }
+}
+
+TEST_CASE("Image sequence", "ImageFrameProviderOpenCv")
+{
+    TemporaryDirectory directory;
+    const auto& frames = createMosaicFrames(4);
+
+    // images of other dimensions than the first one and files which are not images are skipped
+    std::vector<std::string> file_paths;
+    for (std::size_t i = 0; i < 7; i++)
+    {
+        file_paths.push_back(directory.getFilePath("image_" + std::to_string(i) + ".ppm"));
+    }
+
+    writeImage(file_paths[0], frames[0]);
+    writeImage(file_paths[1], frames[1].crop(0, 0, 32, 24));
+    writeImage(file_paths[2], frames[1]);
+    std::ofstream(file_paths[3]) << "not an image";
+    writeImage(file_paths[4], frames[2]);
+    writeImage(file_paths[5], frames[3].crop(0, 0, 64, 40));
+    writeImage(file_paths[6], frames[3]);
+
+    SECTION( "frames are provided only for images of the first image's dimensions" ) 
+    {
+        ImageFrameProviderOpenCv frame_provider(file_paths, 2);
+        REQUIRE (frame_provider.isReady());
+
+        std::vector<Frame> provided_frames;
+        REQUIRE (frame_provider.fill(provided_frames, 10) == 4);
+
+        for (std::size_t i = 0; i < 4; i++)
+        {
+            REQUIRE (provided_frames[i].getWidth() == 64);
+            REQUIRE (provided_frames[i].getHeight() == 48);
+            REQUIRE (provided_frames[i].get(10, 10).m_red == frames[i].get(10, 10).m_red);
+            REQUIRE (provided_frames[i].get(10, 10).m_blue == frames[i].get(10, 10).m_blue);
+        }
+    }
+
+    SECTION( "images of mixed dimensions are decomposed" ) 
+    {
+        ImageFrameProviderOpenCv frame_provider(file_paths, 2);
+        MosaicDecomposer decomposer(frame_provider);
+
+        const auto& dimensions = decomposer.calculateMosaicsDimensions();
+        const layout::Layout expected{{0, 0, 20, 30}, {20, 0, 44, 30}, {0, 30, 20, 18}, {20, 30, 44, 18}};
+
+        REQUIRE (layout::score(dimensions, expected, 1) == Approx(1.));
+    }
+}
+
+#ifdef USE_LIBAV
+TEST_CASE("Video decoded by libav", "VideoFrameProviderLibav")
+{
+    TemporaryDirectory directory;
+    const auto& file_path = directory.getFilePath("video.mp4");
+
+    {
+        FrameWriterOpenCv writer(file_path, true);
+        for (const auto& frame : createMosaicFrames(10))
+        {
+            REQUIRE (writer.write(frame));
+        }
+    }
+
+    SECTION( "missing video is not ready" ) 
+    {
+        VideoFrameProviderLibav frame_provider(directory.getFilePath("missing.mp4"), false);
+        std::vector<Frame> frames;
+
+        REQUIRE (frame_provider.isReady() == false);
+        REQUIRE (frame_provider.fill(frames, 10) == 0);
+        REQUIRE (frame_provider.skip(1) == false);
+    }
+
+    SECTION( "frames are provided in the same channel order as by OpenCV" ) 
+    {
+        VideoFrameProviderLibav frame_provider(file_path, false);
+        VideoFrameProviderOpenCv reference_provider(file_path);
+        REQUIRE (frame_provider.isReady());
+
+        std::vector<Frame> frames;
+        std::vector<Frame> reference_frames;
+        REQUIRE (frame_provider.fill(frames, 20) == 10);
+        REQUIRE (reference_provider.fill(reference_frames, 20) == 10);
+
+        for (std::size_t i = 0; i < 10; i++)
+        {
+            REQUIRE (frames[i].getWidth() == 64);
+            REQUIRE (frames[i].getHeight() == 48);
+
+            // red and blue differ substantially within these mosaics, decoders differ only slightly
+            REQUIRE (frames[i].get(40, 10).coarseCompare(reference_frames[i].get(40, 10)));
+            REQUIRE (frames[i].get(10, 40).coarseCompare(reference_frames[i].get(10, 40)));
+        }
+    }
+
+    SECTION( "skipped frames are not provided" ) 
+    {
+        VideoFrameProviderLibav frame_provider(file_path, false);
+        std::vector<Frame> frames;
+
+        REQUIRE (frame_provider.skip(3));
+        REQUIRE (frame_provider.fill(frames, 20) == 7);
+        REQUIRE (frame_provider.skip(1) == false);
+    }
+
+    SECTION( "only keyframes are provided in keyframes only mode" ) 
+    {
+        VideoFrameProviderLibav frame_provider(file_path, true);
+        std::vector<Frame> frames;
+
+        const auto keyframes = frame_provider.fill(frames, 20);
+        REQUIRE (keyframes > 0);
+        REQUIRE (keyframes <= 10);
+    }
+}
+#endif
+
+TEST_CASE("Topology", "Topology")
+{
+    SECTION( "cpu lists are parsed and formatted" ) 
+    {
+        REQUIRE (topology::parseCpuList("0-3,8,10-11\n") == topology::CpuList{0, 1, 2, 3, 8, 10, 11});
+        REQUIRE (topology::parseCpuList("") == topology::CpuList{});
+        REQUIRE_FALSE (topology::parseCpuList("3-1"));
+        REQUIRE_FALSE (topology::parseCpuList("0-a"));
+
+        REQUIRE (topology::toString({0, 1, 2, 3, 8, 10, 11}) == "0-3,8,10-11");
+        REQUIRE (topology::toString({}) == "");
+    }
+
+#ifdef __linux__
+    // pinning is supported only on linux, other platforms merely warn about it
+    SECTION( "threads are pinned to cpus of the current node" ) 
+    {
+        const auto& nodes = topology::detectNodes();
+        REQUIRE_FALSE (nodes.empty());
+
+        // only cpus allowed for the process are detected, as it may be restricted e.g. by cpuset of a container
+        cpu_set_t allowed_cpus;
+        CPU_ZERO(&allowed_cpus);
+        REQUIRE (sched_getaffinity(0, sizeof(allowed_cpus), &allowed_cpus) == 0);
+
+        for (const auto& detected_node : nodes)
+        {
+            for (const auto cpu : detected_node.m_cpus)
+            {
+                REQUIRE (CPU_ISSET(cpu, &allowed_cpus));
+            }
+        }
+
+        const auto& node = topology::getCurrentNode(nodes);
+        REQUIRE_FALSE (node.m_cpus.empty());
+
+        bool is_thread_pinned = false;
+        bool is_pool_pinned = false;
+        std::atomic<int> sum{0};
+
+        // separate thread is pinned, so that the rest of the tests is not affected
+        std::thread([&]()
+        {
+            is_thread_pinned = topology::pinCurrentThread(node.m_cpus);
+
+            ThreadPool thread_pool(3);
+            is_pool_pinned = thread_pool.pinThreads(node.m_cpus);
+            thread_pool.parallelFor(10, [&sum](std::size_t i) { sum += static_cast<int>(i); });
+        }).join();
+
+        REQUIRE (is_thread_pinned);
+        REQUIRE (is_pool_pinned);
+        REQUIRE (sum == 45);
+    }
+#endif
+}
+
+TEST_CASE("Mosaic decomposition", "MosaicDecomposer")
+{
+    FramesProvider frame_provider(createMosaicFrames(3));
+    MosaicDecomposer decomposer(frame_provider);
+
+    const auto& dimensions = decomposer.calculateMosaicsDimensions();
+    const layout::Layout expected{{0, 0, 20, 30}, {20, 0, 44, 30}, {0, 30, 20, 18}, {20, 30, 44, 18}};
+
+    REQUIRE (dimensions.size() == 4);
+    REQUIRE (layout::score(dimensions, expected, 1) == Approx(1.));
+}
+
+TEST_CASE("Coarse to fine decomposition", "MosaicDecomposer")
+{
+    FramesProvider reference_provider(createMosaicFrames(6));
+    MosaicDecomposer reference_decomposer(reference_provider);
+    const auto& reference_dimensions = reference_decomposer.calculateMosaicsDimensions();
+
+    ConfigParams params;
+    params.m_coarse_line_stride = 4;
+    params.m_refine_radius = 1;
+
+    FramesProvider frame_provider(createMosaicFrames(6));
+    MosaicDecomposer decomposer(frame_provider, params);
+    const auto& dimensions = decomposer.calculateMosaicsDimensions();
+
+    REQUIRE (layout::score(dimensions, reference_dimensions, 0) == Approx(1.));
+}
+
+TEST_CASE("Recursive decomposition", "MosaicDecomposer")
+{
+    std::vector<Frame> frames;
+    for (unsigned i = 0; i < 4; i++)
+    {
+        frames.push_back(createNestedMosaicFrame(i));
+    }
+
+    const layout::Layout expected{{0, 0, 224, 128}, {224, 0, 48, 64}, {224, 64, 48, 64}, {272, 0, 48, 64}, {272, 64, 48, 64}};
+
+    SECTION( "splits of nested mosaics are too weak to be detected in the whole frame" ) 
+    {
+        FramesProvider frame_provider(frames);
+        MosaicDecomposer decomposer(frame_provider);
+
+        REQUIRE (decomposer.calculateMosaicsDimensions().size() == 3);
+    }
+
+    SECTION( "nested mosaics are detected inside of the detected ones" ) 
+    {
+        ConfigParams params;
+        params.m_recursion_depth = 2;
+        params.m_batch_size = 3;
+
+        ThreadPool thread_pool(2);
+        FramesProvider frame_provider(frames);
+        MosaicDecomposer decomposer(frame_provider, params, &thread_pool);
+        const auto& dimensions = decomposer.calculateMosaicsDimensions();
+
+        INFO ("detected: " << layout::toString(dimensions));
+        REQUIRE (dimensions.size() == expected.size());
+        REQUIRE (layout::score(dimensions, expected, 1) == Approx(1.));
+    }
+}
+
+TEST_CASE("Batched decomposition", "MosaicDecomposer")
+{
+    FramesProvider reference_provider(createMosaicFrames(7));
+    MosaicDecomposer reference_decomposer(reference_provider);
+    const auto& reference_state = reference_decomposer.analyzeFrames();
+
+    ThreadPool thread_pool(3);
+
+    for (const uint16_t batch_size : {uint16_t{1}, uint16_t{3}, uint16_t{16}})
+    {
+        ConfigParams params;
+        params.m_batch_size = batch_size;
+
+        FramesProvider frame_provider(createMosaicFrames(7));
+        MosaicDecomposer decomposer(frame_provider, params, &thread_pool);
+        const auto& state = decomposer.analyzeFrames();
+
+        REQUIRE (state->m_processed_frames == 7);
+        REQUIRE (state->m_horizontal.m_split_histogram == reference_state->m_horizontal.m_split_histogram);
+        REQUIRE (state->m_vertical.m_split_histogram == reference_state->m_vertical.m_split_histogram);
+    }
+
+    SECTION( "amount of frames to analyze is respected" ) 
+    {
+        ConfigParams params;
+        params.m_batch_size = 3;
+        params.m_frames_to_analyze = 4;
+
+        FramesProvider frame_provider(createMosaicFrames(7));
+        MosaicDecomposer decomposer(frame_provider, params, &thread_pool);
+
+        REQUIRE (decomposer.analyzeFrames()->m_processed_frames == 4);
+        REQUIRE (frame_provider.getNext().has_value());
+        REQUIRE (frame_provider.getNext().has_value());
+        REQUIRE (frame_provider.getNext().has_value());
+        REQUIRE (frame_provider.getNext().has_value() == false);
+    }
+}
+
+TEST_CASE("Sharded decomposition", "MosaicDecomposer")
+{
+    FramesProvider reference_provider(createMosaicFrames(12));
+    MosaicDecomposer reference_decomposer(reference_provider);
+    const auto& reference_dimensions = reference_decomposer.calculateMosaicsDimensions();
+
+    SECTION( "frames are skipped up to the end of the input" ) 
+    {
+        FramesProvider frame_provider(createMosaicFrames(3));
+
+        REQUIRE (frame_provider.skip(2));
+        REQUIRE (frame_provider.skip(1));
+        REQUIRE (frame_provider.skip(1) == false);
+    }
+
+    SECTION( "merged shards are decomposed the same as the whole input" ) 
+    {
+        AnalysisState merged_state;
+
+        for (const auto& [start_frame, end_frame] : {std::pair{0u, 5u}, std::pair{5u, 12u}, std::pair{12u, 20u}})
+        {
+            ConfigParams params;
+            params.m_start_frame = start_frame;
+            params.m_frames_to_analyze = end_frame - start_frame;
+
+            FramesProvider frame_provider(createMosaicFrames(12));
+            MosaicDecomposer decomposer(frame_provider, params);
+            const auto& state = decomposer.analyzeFrames();
+
+            REQUIRE (state.has_value());
+            REQUIRE (merged_state.merge(*state));
+        }
+
+        REQUIRE (merged_state.m_processed_frames == 12);
+
+        const auto& dimensions = MosaicDecomposer(ConfigParams{}).calculateMosaicsDimensions(merged_state);
+        REQUIRE (layout::score(dimensions, reference_dimensions, 0) == Approx(1.));
+    }
+}
+
+TEST_CASE("Deadline bounded decomposition", "MosaicDecomposer")
+{
+    FramesProvider reference_provider(createMosaicFrames(12));
+    MosaicDecomposer reference_decomposer(reference_provider);
+    const auto& reference = reference_decomposer.decompose(MosaicDecomposer::RunOptions{});
+
+    ConfigParams params;
+    params.m_batch_size = 4;
+
+    SECTION( "whole input is analyzed without the stop" ) 
+    {
+        REQUIRE_FALSE (reference.m_is_interrupted);
+        REQUIRE (reference.m_processed_frames == 12);
+        REQUIRE (reference.m_margins.m_weakest_accepted >= 1.);
+        REQUIRE (reference.m_margins.m_strongest_dropped < 1.);
+    }
+
+    SECTION( "cancellation stops the acquisition after the first batch" ) 
+    {
+        const std::atomic<bool> is_cancelled{true};
+        MosaicDecomposer::RunOptions options;
+        options.m_cancellation = &is_cancelled;
+
+        FramesProvider frame_provider(createMosaicFrames(12));
+        MosaicDecomposer decomposer(frame_provider, params);
+        const auto& result = decomposer.decompose(options);
+
+        REQUIRE (result.m_is_interrupted);
+        REQUIRE (result.m_processed_frames == 4);
+        REQUIRE (layout::score(result.m_dimensions, reference.m_dimensions, 0) == Approx(1.));
+    }
+
+    SECTION( "passed deadline stops the acquisition after the first batch" ) 
+    {
+        FramesProvider frame_provider(createMosaicFrames(12));
+        MosaicDecomposer decomposer(frame_provider, params);
+        const auto& result = decomposer.decompose(MosaicDecomposer::RunOptions::withTimeout(std::chrono::milliseconds(0)));
+
+        REQUIRE (result.m_is_interrupted);
+        REQUIRE (result.m_processed_frames == 4);
+    }
+
+    SECTION( "stop is not reported once requested frames are analyzed" ) 
+    {
+        params.m_frames_to_analyze = 4;
+
+        FramesProvider frame_provider(createMosaicFrames(12));
+        MosaicDecomposer decomposer(frame_provider, params);
+        const auto& result = decomposer.decompose(MosaicDecomposer::RunOptions::withTimeout(std::chrono::milliseconds(0)));
+
+        REQUIRE_FALSE (result.m_is_interrupted);
+        REQUIRE (result.m_processed_frames == 4);
+    }
+}
+
+TEST_CASE("Duplicate frames skipping", "MosaicDecomposer")
+{
+    // every distinct frame is followed by two of its copies
+    std::vector<Frame> frames;
+    for (const auto& frame : createMosaicFrames(6))
+    {
+        frames.insert(frames.end(), 3, frame);
+    }
+
+    FramesProvider reference_provider(createMosaicFrames(6));
+    MosaicDecomposer reference_decomposer(reference_provider);
+    const auto& reference_state = reference_decomposer.analyzeFrames();
+
+    ThreadPool thread_pool(3);
+
+    SECTION( "copies are skipped and distinct frames are analyzed" ) 
+    {
+        ConfigParams params;
+        params.m_batch_size = 4;
+        params.m_duplicate_frame_diff = 1;
+
+        FramesProvider frame_provider(frames);
+        MosaicDecomposer decomposer(frame_provider, params, &thread_pool);
+        const auto& state = decomposer.analyzeFrames();
+
+        REQUIRE (state->m_processed_frames == 18);
+        REQUIRE (state->m_skipped_frames == 12);
+        REQUIRE (state->m_horizontal.m_split_histogram == reference_state->m_horizontal.m_split_histogram);
+        REQUIRE (state->m_vertical.m_split_histogram == reference_state->m_vertical.m_split_histogram);
+    }
+
+    SECTION( "nothing is skipped when disabled" ) 
+    {
+        FramesProvider frame_provider(frames);
+        MosaicDecomposer decomposer(frame_provider, ConfigParams{}, &thread_pool);
+
+        REQUIRE (decomposer.analyzeFrames()->m_skipped_frames == 0);
+    }
+
+    SECTION( "threshold is applied to the average difference of thumbnails" ) 
+    {
+        Frame frame(40, 30);
+        Frame brighter_frame(40, 30);
+        for (Frame::DimensionsType x = 0; x < frame.getWidth(); x++)
+        {
+            for (Frame::DimensionsType y = 0; y < frame.getHeight(); y++)
+            {
+                frame.set(x, y, Pixel{100, 100, 100});
+                brighter_frame.set(x, y, Pixel{102, 102, 102});
+            }
+        }
+
+        REQUIRE (FrameSignature(frame).getDifference(FrameSignature(brighter_frame)) == 6 * FrameSignature::CELL_COUNT);
+
+        DuplicateFrameFilter loose_filter(7);
+        REQUIRE (loose_filter.isDuplicate(frame) == false);
+        REQUIRE (loose_filter.isDuplicate(brighter_frame) == true);
+
+        DuplicateFrameFilter strict_filter(6);
+        REQUIRE (strict_filter.isDuplicate(frame) == false);
+        REQUIRE (strict_filter.isDuplicate(brighter_frame) == false);
+        REQUIRE (strict_filter.isDuplicate(frame) == false);
+    }
+}
+
+TEST_CASE("Frame regions", "Frame")
+{
+    Frame frame(6, 4);
+    for (Frame::DimensionsType x = 0; x < frame.getWidth(); x++)
+    {
+        for (Frame::DimensionsType y = 0; y < frame.getHeight(); y++)
+        {
+            frame.set(x, y, Pixel{static_cast<Pixel::Color>(x), static_cast<Pixel::Color>(y), 0});
+        }
+    }
+
+    const auto region = frame.crop(2, 1, 3, 2);
+
+    SECTION( "region shares pixels of the frame" ) 
+    {
+        REQUIRE (region.getWidth() == 3);
+        REQUIRE (region.getHeight() == 2);
+        REQUIRE (region.get(0, 0).m_red == 2);
+        REQUIRE (region.get(0, 0).m_green == 1);
+        REQUIRE (region.get(2, 1).m_red == 4);
+        REQUIRE (region.get(2, 1).m_green == 2);
+        REQUIRE (region.getColumnData(1)[1].m_red == 3);
+        REQUIRE (region.getColumnData(1)[1].m_green == 2);
+    }
+
+    SECTION( "region detaches on modification" ) 
+    {
+        auto modified_region = region;
+        modified_region.set(0, 0, Pixel{100, 100, 100});
+
+        REQUIRE (modified_region.get(0, 0).m_red == 100);
+        REQUIRE (region.get(0, 0).m_red == 2);
+        REQUIRE (frame.get(2, 1).m_red == 2);
+    }
+
+    SECTION( "region can be rotated and rotated frame can be cropped" ) 
+    {
+        const auto rotated_region = region.rotate90();
+        const auto region_of_rotated = frame.rotate90().crop(1, 2, 2, 3);
+
+        REQUIRE (rotated_region.getWidth() == 2);
+        REQUIRE (rotated_region.getHeight() == 3);
+        REQUIRE (region_of_rotated.getWidth() == 2);
+        REQUIRE (region_of_rotated.getHeight() == 3);
+
+        for (Frame::DimensionsType x = 0; x < 2; x++)
+        {
+            for (Frame::DimensionsType y = 0; y < 3; y++)
+            {
+                const auto expected = frame.rotate90().get(static_cast<Frame::DimensionsType>(x + 1), 
+                    static_cast<Frame::DimensionsType>(y + 2));
+                REQUIRE (region_of_rotated.get(x, y).m_red == expected.m_red);
+                REQUIRE (region_of_rotated.get(x, y).m_green == expected.m_green);
+            }
+        }
+
+        REQUIRE (rotated_region.get(0, 0).m_red == 2);
+        REQUIRE (rotated_region.get(0, 0).m_green == 2);
+    }
+
+    SECTION( "region must fit into the frame" ) 
+    {
+        REQUIRE_THROWS_AS (frame.crop(4, 0, 3, 1), std::runtime_error);
+    }
+}
+
+TEST_CASE("Frame reuse", "Frame")
+{
+    Frame frame(4, 3);
+    frame.set(1, 1, Pixel{1, 2, 3});
+
+    auto shared = frame;
+    auto rotated = frame.rotate90();
+
+    // shared memory cannot be reused, since other frames would be altered
+    frame.reuse(4, 3);
+    frame.set(1, 1, Pixel{4, 5, 6});
+
+    REQUIRE (shared.get(1, 1).m_red == 1);
+    REQUIRE (rotated.getWidth() == 3);
+
+    // transposition is dropped when the frame is reused
+    rotated.reuse(2, 5);
+
+    REQUIRE (rotated.getWidth() == 2);
+    REQUIRE (rotated.getHeight() == 5);
+}
+
+TEST_CASE("Memory frame provider", "MemoryFrameProvider")
+{
+    const auto& frame = createMosaicFrame(20, 30, 0);
+
+    for (const auto format : {PixelFormat::Rgb24, PixelFormat::Bgr24, PixelFormat::Rgba32, PixelFormat::Bgra32})
+    {
+        const auto bytes_per_pixel = FrameBuffer::getBytesPerPixel(format);
+        const auto is_bgr = format == PixelFormat::Bgr24 || format == PixelFormat::Bgra32;
+        // rows are padded, as e.g. by decoders which align them
+        const std::size_t stride = frame.getWidth() * bytes_per_pixel + 12;
+
+        std::vector<uint8_t> data(stride * frame.getHeight());
+        for (Frame::DimensionsType y = 0; y < frame.getHeight(); y++)
+        {
+            for (Frame::DimensionsType x = 0; x < frame.getWidth(); x++)
+            {
+                auto* pixel = data.data() + y * stride + x * bytes_per_pixel;
+                pixel[is_bgr ? 2 : 0] = frame.get(x, y).m_red;
+                pixel[1] = frame.get(x, y).m_green;
+                pixel[is_bgr ? 0 : 2] = frame.get(x, y).m_blue;
+            }
+        }
+
+        const FrameBuffer buffer{data.data(), frame.getWidth(), frame.getHeight(), stride, format};
+        const std::vector<FrameBuffer> buffers{buffer, buffer};
+
+        MemoryFrameProvider frame_provider;
+        frame_provider.assign(buffers.data(), buffers.size());
+
+        std::vector<Frame> frames;
+        REQUIRE (frame_provider.fill(frames, 4) == 2);
+        REQUIRE (frame_provider.fill(frames, 4) == 0);
+
+        for (Frame::DimensionsType x = 0; x < frame.getWidth(); x += 7)
+        {
+            for (Frame::DimensionsType y = 0; y < frame.getHeight(); y += 5)
+            {
+                REQUIRE (frames[1].get(x, y).m_red == frame.get(x, y).m_red);
+                REQUIRE (frames[1].get(x, y).m_blue == frame.get(x, y).m_blue);
+            }
+        }
+    }
+}
+
+TEST_CASE("File prefetching", "FilePrefetcher")
+{
+    TemporaryDirectory directory;
+    std::vector<std::string> file_paths;
+    for (std::size_t i = 0; i < 7; i++)
+    {
+        file_paths.push_back(directory.getFilePath("prefetcher_test_" + std::to_string(i) + ".bin"));
+
+        // one of the files is missing
+        if (i != 3)
+        {
+            std::ofstream file(file_paths.back(), std::ios::binary);
+            file << std::string(i * 100 + 1, static_cast<char>('a' + i));
+        }
+    }
+
+    SECTION( "files are provided in order" ) 
+    {
+        FilePrefetcher prefetcher(file_paths, 2);
+        REQUIRE (prefetcher.getFileCount() == 7);
+
+        for (std::size_t i = 0; i < file_paths.size(); i++)
+        {
+            const auto* buffer = prefetcher.next();
+            REQUIRE (buffer != nullptr);
+            REQUIRE (buffer->m_path == file_paths[i]);
+            REQUIRE (buffer->m_is_read == (i != 3));
+
+            if (i != 3)
+            {
+                REQUIRE (buffer->m_data.size() == i * 100 + 1);
+                REQUIRE (std::all_of(buffer->m_data.begin(), buffer->m_data.end(), 
+                    [i](uint8_t value) { return value == 'a' + i; }));
+            }
+            else
+            {
+                REQUIRE (buffer->m_data.empty());
+            }
+        }
+
+        REQUIRE (prefetcher.next() == nullptr);
+        REQUIRE (prefetcher.next() == nullptr);
+    }
+
+    SECTION( "prefetching stops when it's destroyed early" ) 
+    {
+        auto prefetcher = std::make_unique<FilePrefetcher>(file_paths, 3);
+        REQUIRE (prefetcher->next() != nullptr);
+
+        // readers are left waiting for slots of the unconsumed files, destruction has to wake them up
+        std::promise<void> destroyed;
+        auto is_destroyed = destroyed.get_future();
+        std::thread destroyer([prefetcher = std::move(prefetcher), destroyed = std::move(destroyed)]() mutable
+        {
+            prefetcher.reset();
+            destroyed.set_value();
+        });
+
+        const auto status = is_destroyed.wait_for(std::chrono::seconds(10));
+        if (status == std::future_status::ready)
+        {
+            destroyer.join();
+        }
+        else
+        {
+            destroyer.detach();
+        }
+
+        REQUIRE (status == std::future_status::ready);
+    }
+}
+
+TEST_CASE("Embedded decomposition", "DecomposerApi")
+{
+    const auto& source_frames = createMosaicFrames(3);
+    const std::size_t stride = 64 * 3;
+
+    std::vector<std::vector<uint8_t>> buffers;
+    std::vector<md::FrameView> frames;
+    for (const auto& frame : source_frames)
+    {
+        auto& data = buffers.emplace_back(stride * frame.getHeight());
+        for (Frame::DimensionsType y = 0; y < frame.getHeight(); y++)
+        {
+            for (Frame::DimensionsType x = 0; x < frame.getWidth(); x++)
+            {
+                data[y * stride + x * 3u] = frame.get(x, y).m_red;
+                data[y * stride + x * 3u + 1u] = frame.get(x, y).m_green;
+                data[y * stride + x * 3u + 2u] = frame.get(x, y).m_blue;
+            }
+        }
+
+        frames.push_back(md::FrameView{data.data(), frame.getWidth(), frame.getHeight(), stride, MD_PIXEL_FORMAT_RGB24});
+    }
+
+    const layout::Layout expected{{0, 0, 20, 30}, {20, 0, 44, 30}, {0, 30, 20, 18}, {20, 30, 44, 18}};
+
+    SECTION( "layout is the same on subsequent calls" ) 
+    {
+        md::Decomposer decomposer;
+        std::vector<md::Mosaic> mosaics;
+
+        for (int i = 0; i < 2; i++)
+        {
+            REQUIRE (decomposer.decompose(frames, mosaics) == MD_OK);
+
+            layout::Layout dimensions;
+            for (const auto& mosaic : mosaics)
+            {
+                dimensions.push_back({static_cast<Frame::DimensionsType>(mosaic.x), static_cast<Frame::DimensionsType>(mosaic.y),
+                    static_cast<Frame::DimensionsType>(mosaic.width), static_cast<Frame::DimensionsType>(mosaic.height)});
+            }
+
+            REQUIRE (dimensions.size() == expected.size());
+            REQUIRE (layout::score(dimensions, expected, 1) == Approx(1.));
+        }
+    }
+
+    SECTION( "required capacity is reported" ) 
+    {
+        auto config = md::defaultConfig();
+        config.threads = 2;
+        md_decomposer* decomposer = md_create(&config);
+        REQUIRE (decomposer != nullptr);
+
+        std::size_t mosaic_count = 0;
+        REQUIRE (md_get_last_mosaics(decomposer, nullptr, 0, &mosaic_count) == MD_FAILURE);
+        REQUIRE (md_decompose(decomposer, frames.data(), frames.size(), nullptr, 0, &mosaic_count) == MD_INSUFFICIENT_CAPACITY);
+        REQUIRE (mosaic_count == expected.size());
+
+        // mosaics of the last call are handed out without analyzing the frames again
+        std::vector<md_mosaic> mosaics(mosaic_count);
+        REQUIRE (md_get_last_mosaics(decomposer, mosaics.data(), mosaics.size(), &mosaic_count) == MD_OK);
+        REQUIRE (mosaic_count == expected.size());
+
+        layout::Layout dimensions;
+        for (const auto& mosaic : mosaics)
+        {
+            dimensions.push_back({static_cast<Frame::DimensionsType>(mosaic.x), static_cast<Frame::DimensionsType>(mosaic.y),
+                static_cast<Frame::DimensionsType>(mosaic.width), static_cast<Frame::DimensionsType>(mosaic.height)});
+        }
+
+        REQUIRE (layout::score(dimensions, expected, 1) == Approx(1.));
+
+        md_destroy(decomposer);
+    }
+
+    SECTION( "invalid frames are rejected" ) 
+    {
+        md::Decomposer decomposer;
+        std::vector<md::Mosaic> mosaics;
+
+        auto invalid_frames = frames;
+        invalid_frames[1].stride = 64 * 3 - 1;
+        REQUIRE (decomposer.decompose(invalid_frames, mosaics) == MD_INVALID_ARGUMENT);
+
+        invalid_frames = frames;
+        invalid_frames[2].width = 32;
+        REQUIRE (decomposer.decompose(invalid_frames, mosaics) == MD_INCONSISTENT_FRAMES);
+        REQUIRE (mosaics.empty());
+    }
+
+    SECTION( "invalid config is rejected" ) 
+    {
+        auto config = md::defaultConfig();
+        config.recursion_depth = 1000;
+
+        REQUIRE (md_create(&config) == nullptr);
+        REQUIRE_THROWS_AS (md::Decomposer(config), std::invalid_argument);
+    }
+
+    SECTION( "configs of older and newer versions are accepted" ) 
+    {
+        // config of an older version lacks the amount of threads, it must be neither written nor read
+        md_config older_config;
+        std::memset(&older_config, 0xff, sizeof(older_config));
+        older_config.size = offsetof(md_config, threads);
+        md_get_default_config(&older_config);
+
+        REQUIRE (older_config.size == offsetof(md_config, threads));
+        REQUIRE (older_config.pixel_match_ratio == Approx(md::defaultConfig().pixel_match_ratio));
+        REQUIRE (older_config.threads == std::numeric_limits<uint32_t>::max());
+
+        md_decomposer* decomposer = md_create(&older_config);
+        REQUIRE (decomposer != nullptr);
+
+        std::size_t mosaic_count = 0;
+        std::vector<md_mosaic> mosaics(expected.size());
+        REQUIRE (md_decompose(decomposer, frames.data(), frames.size(), mosaics.data(), mosaics.size(), &mosaic_count) == MD_OK);
+        md_destroy(decomposer);
+
+        // fields of a newer version are ignored only when they are zero
+        struct
+        {
+            md_config m_config;
+            uint64_t m_unknown_field;
+        } newer_config{md::defaultConfig(), 0};
+        newer_config.m_config.size = sizeof(newer_config);
+
+        decomposer = md_create(&newer_config.m_config);
+        REQUIRE (decomposer != nullptr);
+        md_destroy(decomposer);
+
+        newer_config.m_unknown_field = 1;
+        REQUIRE (md_create(&newer_config.m_config) == nullptr);
+
+        md_config uninitialized_config{};
+        REQUIRE (md_create(&uninitialized_config) == nullptr);
+    }
+
+    SECTION( "log level is set" ) 
+    {
+        REQUIRE (md_set_log_level(static_cast<md_log_level>(5)) == MD_INVALID_ARGUMENT);
+        REQUIRE_THROWS_AS (md::setLogLevel(static_cast<md_log_level>(7)), std::invalid_argument);
+
+        md::setLogLevel(MD_LOG_LEVEL_OFF);
+        md::Decomposer decomposer;
+        std::vector<md::Mosaic> mosaics;
+        REQUIRE (decomposer.decompose(frames, mosaics) == MD_OK);
+        REQUIRE (mosaics.size() == expected.size());
+
+        // rest of the tests logs as before
+        md::setLogLevel(MD_LOG_LEVEL_INFO);
+    }
+}
+
+#ifdef USE_SERVER
+namespace
+{
+    // provides frames only once the gate is opened, so that the job keeps its worker busy until then
+    class GatedFramesProvider : public FramesProvider
+    {
+    public:
+        GatedFramesProvider(std::vector<Frame> frames, const std::atomic<bool>& is_open) :
+            FramesProvider(std::move(frames)), m_is_open(is_open) {}
+
+        std::size_t fill(std::vector<Frame>& frames, std::size_t max_frames) override
+        {
+            while (!m_is_open)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            return FramesProvider::fill(frames, max_frames);
+        }
+
+    private:
+        const std::atomic<bool>& m_is_open;
+    };
+
+    // provides frames slowly and never runs out of them
+    class EndlessFramesProvider : public FrameProviderInterface
+    {
+    public:
+        bool isReady() const override { return true; }
+
+        std::size_t fill(std::vector<Frame>& frames, std::size_t max_frames) override
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            for (std::size_t i = 0; i < max_frames; i++)
+            {
+                storeFrame(frames, i, createMosaicFrame(20, 30, 0));
+            }
+
+            return max_frames;
+        }
+    };
+
+    std::string sendRequest(const std::string& socket_path, const std::string& request)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::copy(socket_path.begin(), socket_path.end(), address.sun_path);
+
+        const auto client_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connect(client_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            close(client_socket);
+            return "connection failed";
+        }
+
+        const auto line = request + '\n';
+        send(client_socket, line.data(), line.size(), MSG_NOSIGNAL);
+
+        std::string response;
+        char character = 0;
+        while (recv(client_socket, &character, 1, 0) == 1 && character != '\n')
+        {
+            response.push_back(character);
+        }
+
+        close(client_socket);
+        return response;
+    }
+}
+
+TEST_CASE("Decomposition server", "DecompositionServer")
+{
+    const auto socket_path = "/tmp/mosaicdecomposer-test-" + std::to_string(getpid()) + ".sock";
+    std::atomic<bool> is_gate_open{false};
+
+    ServerParams params;
+    params.m_socket_path = socket_path;
+    params.m_worker_count = 1;
+    params.m_max_queued_jobs = 1;
+
+    DecompositionServer server(params, [&is_gate_open](const DecompositionJob& job) -> std::unique_ptr<FrameProviderInterface>
+    {
+        if (job.m_file_path == "gated")
+        {
+            return std::make_unique<GatedFramesProvider>(createMosaicFrames(3), is_gate_open);
+        }
+
+        if (job.m_file_path == "endless")
+        {
+            return std::make_unique<EndlessFramesProvider>();
+        }
+
+        if (job.m_file_path == "missing")
+        {
+            return nullptr;
+        }
+
+        return std::make_unique<FramesProvider>(createMosaicFrames(3));
+    });
+
+    REQUIRE (server.start());
+
+    SECTION( "requests are served" ) 
+    {
+        FramesProvider frame_provider(createMosaicFrames(3));
+        MosaicDecomposer decomposer(frame_provider);
+        const auto& expected = "ok " + layout::toString(decomposer.calculateMosaicsDimensions()) + 
+            " interrupted=0 frames=3 margin=";
+
+        REQUIRE (sendRequest(socket_path, "health") == "ok");
+        REQUIRE (sendRequest(socket_path, "decompose video frames.mp4").rfind(expected, 0) == 0);
+        REQUIRE (sendRequest(socket_path, "decompose image frames.png color-match=80 line-match=1.8").rfind(expected, 0) == 0);
+        REQUIRE (sendRequest(socket_path, "decompose video missing").rfind("error", 0) == 0);
+        REQUIRE (sendRequest(socket_path, "stats") ==
+            "ok completed=2 failed=1 rejected=0 timed_out=0 queued=0 running=0 workers=1");
+    }
+
+    SECTION( "invalid requests are rejected" ) 
+    {
+        REQUIRE (sendRequest(socket_path, "decompose").rfind("error", 0) == 0);
+        REQUIRE (sendRequest(socket_path, "decompose audio frames.mp4").rfind("error", 0) == 0);
+        REQUIRE (sendRequest(socket_path, "decompose video frames.mp4 frames=-1").rfind("error", 0) == 0);
+        REQUIRE (sendRequest(socket_path, "decompose video frames.mp4 unknown=1").rfind("error", 0) == 0);
+        REQUIRE (sendRequest(socket_path, "unknown").rfind("error", 0) == 0);
+
+        std::string error;
+        const auto& job = DecompositionServer::parseJob("decompose image a.png recursion=2 timeout=100", error);
+        REQUIRE (job);
+        REQUIRE_FALSE (job->m_is_video);
+        REQUIRE (job->m_params.m_recursion_depth == 2);
+        REQUIRE (job->m_timeout == std::chrono::milliseconds(100));
+        REQUIRE_FALSE (DecompositionServer::parseJob("decompose image a.png recursion=256", error));
+    }
+
+    SECTION( "jobs exceeding the queue are rejected" ) 
+    {
+        const auto& wait_for = [&server](std::size_t running_jobs, std::size_t queued_jobs)
+        {
+            while (server.getStatistics().m_running_jobs != running_jobs || 
+                server.getStatistics().m_queued_jobs != queued_jobs)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        };
+
+        std::string running_response;
+        std::thread running_client([&]() { running_response = sendRequest(socket_path, "decompose video gated"); });
+        wait_for(1, 0);
+
+        std::string queued_response;
+        std::thread queued_client([&]() { queued_response = sendRequest(socket_path, "decompose video gated"); });
+        wait_for(1, 1);
+
+        REQUIRE (sendRequest(socket_path, "decompose video gated") == "error busy");
+
+        is_gate_open = true;
+        running_client.join();
+        queued_client.join();
+
+        REQUIRE (running_response.rfind("ok", 0) == 0);
+        REQUIRE (queued_response == running_response);
+        REQUIRE (server.getStatistics().m_rejected_jobs == 1);
+    }
+
+    SECTION( "jobs exceeding the timeout respond with the layout analyzed so far" ) 
+    {
+        const auto& response = sendRequest(socket_path, "decompose video endless timeout=50");
+
+        REQUIRE (response.rfind("ok (0;0)", 0) == 0);
+        REQUIRE (response.find(" interrupted=1 frames=") != std::string::npos);
+        REQUIRE (server.getStatistics().m_timed_out_jobs == 1);
+    }
+
+    SECTION( "jobs timing out in the queue are not run" ) 
+    {
+        std::string running_response;
+        std::thread running_client([&]() { running_response = sendRequest(socket_path, "decompose video gated"); });
+        while (server.getStatistics().m_running_jobs != 1)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        std::string queued_response;
+        std::thread queued_client([&]() { queued_response = sendRequest(socket_path, "decompose video gated timeout=1"); });
+        while (server.getStatistics().m_queued_jobs != 1)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        is_gate_open = true;
+        running_client.join();
+        queued_client.join();
+
+        REQUIRE (running_response.rfind("ok", 0) == 0);
+        REQUIRE (queued_response == "error timeout");
+        REQUIRE (server.getStatistics().m_timed_out_jobs == 1);
+    }
+
+    server.stop();
+    REQUIRE (sendRequest(socket_path, "health") == "connection failed");
+}
+#endif
+
+TEST_CASE("Parameter sweep", "ParameterSweep")
+{
+    ThreadPool thread_pool(3);
+    FramesProvider frame_provider(createMosaicFrames(3));
+
+    SweepGrid grid;
+    grid.m_pixel_match_ratios = {1.5, 3.};
+    grid.m_color_match_diffs = {5, 80, 20};
+    grid.m_line_match_ratios = {1.8, 1.2};
+
+    ParameterSweep sweep(frame_provider, thread_pool, ConfigParams{}, grid);
+    const auto& results = sweep.run();
+
+    REQUIRE (results.size() == 12);
+
+    // every configuration shall yield the same dimensions as a separate run of the decomposer
+    for (const auto& result : results)
+    {
+        FramesProvider single_provider(createMosaicFrames(3));
+        MosaicDecomposer decomposer(single_provider, result.m_params);
+
+        const auto& expected = decomposer.calculateMosaicsDimensions();
+
+        REQUIRE (result.m_dimensions.size() == expected.size());
+        REQUIRE (layout::score(result.m_dimensions, expected, 0) == Approx(1.));
+    }
+
+    REQUIRE (results.front().m_params.m_minimum_pixel_match_ratio == Approx(1.5));
+    REQUIRE (results.front().m_params.m_minimum_color_match_diff == 5);
+    REQUIRE (results.front().m_params.m_minimum_line_match_ratio == Approx(1.2));
+}
+
+TEST_CASE("Layout scoring", "Layout")
+{
+    const layout::Layout expected{{0, 0, 10, 10}, {10, 0, 10, 10}};
+
+    REQUIRE (layout::score(expected, expected) == Approx(1.));
+    REQUIRE (layout::score({{1, 0, 9, 10}, {10, 0, 10, 10}}, expected, 1) == Approx(1.));
+    REQUIRE (layout::score({{0, 0, 20, 10}}, expected) == Approx(0.));
+    REQUIRE (layout::score({{0, 0, 10, 10}, {10, 0, 5, 10}, {15, 0, 5, 10}}, expected) == Approx(0.4));
+}